@@ -0,0 +1,378 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <pthread.h>
+#include "priority_queue.h"
+#include "pq_helper.h"
+#include "concurrent_priority_queue.h"
+
+#define NULL_INPUT_ERROR -1
+#define DEFAULT_SHARD_COUNT 8
+#define CACHE_LINE_SIZE 64
+
+/**
+* A shard of the queue. Padded so the locks of two shards are not on the same cache line.
+* Changes take the lock for writing, and iterators take it for reading.
+*/
+typedef struct shard_t
+{
+    pthread_rwlock_t lock;
+    PriorityQueue queue;
+    char padding[CACHE_LINE_SIZE];
+} *Shard;
+
+struct ConcurrentPriorityQueue_t
+{
+    Shard shards;
+    int shard_count;
+    PQConcurrentOrder order;
+    unsigned int next_shard;
+    int size;
+};
+
+static void destroyShards(ConcurrentPriorityQueue queue, int shard_count)
+{
+    for (int i = 0; i < shard_count; i++)
+    {
+        pqDestroy(queue->shards[i].queue);
+        pthread_rwlock_destroy(&queue->shards[i].lock);
+    }
+}
+
+/** Returns a different shard index on every call, spread over all the shards */
+static int pickShard(ConcurrentPriorityQueue queue)
+{
+    unsigned int ticket = __atomic_fetch_add(&queue->next_shard, 1, __ATOMIC_RELAXED);
+
+    // mix the ticket bits, so two picks in a row are not neighbours
+    ticket = ((ticket >> 16) ^ ticket) * 0x45d9f3bu;
+    ticket = (ticket >> 16) ^ ticket;
+
+    return (int)(ticket % (unsigned int)queue->shard_count);
+}
+
+/** Locks a shard to insert into, preferring a shard that no other thread holds */
+static Shard lockShardForInsert(ConcurrentPriorityQueue queue)
+{
+    int first = pickShard(queue);
+
+    for (int i = 0; i < queue->shard_count; i++)
+    {
+        Shard shard = &queue->shards[(first + i) % queue->shard_count];
+        if (pthread_rwlock_trywrlock(&shard->lock) == 0)
+        {
+            return shard;
+        }
+    }
+
+    // all the shards are busy, wait for the first one
+    Shard shard = &queue->shards[first];
+    pthread_rwlock_wrlock(&shard->lock);
+    return shard;
+}
+
+/** Returns the shard of the two that its first node comes first, or NULL if both are empty */
+static Shard chooseBetterShard(Shard first, Shard second)
+{
+    ElementNode first_node = first != NULL ? getFirstElementNode(first->queue) : NULL;
+    ElementNode second_node = second != NULL ? getFirstElementNode(second->queue) : NULL;
+
+    if (first_node == NULL)
+    {
+        return second_node != NULL ? second : NULL;
+    }
+    if (second_node == NULL)
+    {
+        return first;
+    }
+
+    return compareElementNodes(first->queue, first_node, second_node) > 0 ? first : second;
+}
+
+static PQElement popFromShard(ConcurrentPriorityQueue queue, Shard shard, PQElementPriority* priority)
+{
+    PQElement element = pqPop(shard->queue, priority);
+    if (element != NULL)
+    {
+        __atomic_fetch_sub(&queue->size, 1, __ATOMIC_RELAXED);
+    }
+
+    return element;
+}
+
+static PQElement popStrict(ConcurrentPriorityQueue queue, PQElementPriority* priority)
+{
+    // the shards are always locked by their index order, so two pops never deadlock
+    Shard best_shard = NULL;
+    for (int i = 0; i < queue->shard_count; i++)
+    {
+        pthread_rwlock_wrlock(&queue->shards[i].lock);
+        best_shard = chooseBetterShard(best_shard, &queue->shards[i]);
+    }
+
+    PQElement element = best_shard != NULL ? popFromShard(queue, best_shard, priority) : NULL;
+
+    for (int i = queue->shard_count - 1; i >= 0; i--)
+    {
+        pthread_rwlock_unlock(&queue->shards[i].lock);
+    }
+
+    return element;
+}
+
+static PQElement popRelaxed(ConcurrentPriorityQueue queue, PQElementPriority* priority)
+{
+    int first = pickShard(queue);
+    int second = pickShard(queue);
+    if (first == second)
+    {
+        second = (first + 1) % queue->shard_count;
+    }
+    if (second < first)
+    {
+        int temp = first;
+        first = second;
+        second = temp;
+    }
+
+    PQElement element = NULL;
+    pthread_rwlock_wrlock(&queue->shards[first].lock);
+    pthread_rwlock_wrlock(&queue->shards[second].lock);
+
+    Shard best_shard = chooseBetterShard(&queue->shards[first], &queue->shards[second]);
+    if (best_shard != NULL)
+    {
+        element = popFromShard(queue, best_shard, priority);
+    }
+
+    pthread_rwlock_unlock(&queue->shards[second].lock);
+    pthread_rwlock_unlock(&queue->shards[first].lock);
+
+    // both shards were empty, take any element that is left
+    for (int i = 0; element == NULL && i < queue->shard_count; i++)
+    {
+        if (__atomic_load_n(&queue->size, __ATOMIC_RELAXED) == 0)
+        {
+            break;
+        }
+
+        pthread_rwlock_wrlock(&queue->shards[i].lock);
+        element = popFromShard(queue, &queue->shards[i], priority);
+        pthread_rwlock_unlock(&queue->shards[i].lock);
+    }
+
+    return element;
+}
+
+ConcurrentPriorityQueue pqCreateConcurrent(CopyPQElement copy_element,
+                                           FreePQElement free_element,
+                                           EqualPQElements equal_elements,
+                                           CopyPQElementPriority copy_priority,
+                                           FreePQElementPriority free_priority,
+                                           ComparePQElementPriorities compare_priorities,
+                                           const PQOptions* options,
+                                           int shard_count,
+                                           PQConcurrentOrder order)
+{
+    // a shard that evicts or rejects by its own size would not bound the whole queue
+    if (shard_count < 0 || (order != PQ_ORDER_STRICT && order != PQ_ORDER_RELAXED) ||
+        (options != NULL && options->capacity != 0))
+    {
+        return NULL;
+    }
+
+    ConcurrentPriorityQueue new_queue = (ConcurrentPriorityQueue)malloc(sizeof(struct ConcurrentPriorityQueue_t));
+    if (new_queue == NULL)
+    {
+        return NULL;
+    }
+
+    new_queue->shard_count = shard_count == 0 ? DEFAULT_SHARD_COUNT : shard_count;
+    new_queue->order = order;
+    new_queue->next_shard = 0;
+    new_queue->size = 0;
+    new_queue->shards = (Shard)malloc(new_queue->shard_count * sizeof(struct shard_t));
+    if (new_queue->shards == NULL)
+    {
+        free(new_queue);
+        return NULL;
+    }
+
+    for (int i = 0; i < new_queue->shard_count; i++)
+    {
+        Shard shard = &new_queue->shards[i];
+        shard->queue = pqCreateWithOptions(copy_element, free_element, equal_elements,
+                                           copy_priority, free_priority, compare_priorities, options);
+        if (shard->queue == NULL)
+        {
+            destroyShards(new_queue, i);
+            free(new_queue->shards);
+            free(new_queue);
+            return NULL;
+        }
+
+        if (pthread_rwlock_init(&shard->lock, NULL) != 0)
+        {
+            pqDestroy(shard->queue);
+            destroyShards(new_queue, i);
+            free(new_queue->shards);
+            free(new_queue);
+            return NULL;
+        }
+    }
+
+    return new_queue;
+}
+
+void pqConcurrentDestroy(ConcurrentPriorityQueue queue)
+{
+    if (queue == NULL)
+    {
+        return;
+    }
+
+    destroyShards(queue, queue->shard_count);
+    free(queue->shards);
+    free(queue);
+}
+
+/**
+* Locks a shard for reading, with its element list ready to iterate.
+* A heap shard builds its list lazily, which is a change, so it is built under the write lock first.
+*/
+static void lockShardForIteration(Shard shard)
+{
+    while (true)
+    {
+        pthread_rwlock_rdlock(&shard->lock);
+        if (shard->queue->engine == PQ_ENGINE_SORTED_LIST || shard->queue->is_element_list_valid)
+        {
+            return;
+        }
+        pthread_rwlock_unlock(&shard->lock);
+
+        pthread_rwlock_wrlock(&shard->lock);
+        getElementList(shard->queue);
+        pthread_rwlock_unlock(&shard->lock);
+    }
+}
+
+PriorityQueueResult pqConcurrentInsert(ConcurrentPriorityQueue queue, PQElement element,
+                                       PQElementPriority priority)
+{
+    if (queue == NULL || element == NULL || priority == NULL)
+    {
+        return PQ_NULL_ARGUMENT;
+    }
+
+    Shard shard = lockShardForInsert(queue);
+    PriorityQueueResult result = pqInsert(shard->queue, element, priority);
+    if (result == PQ_SUCCESS)
+    {
+        __atomic_fetch_add(&queue->size, 1, __ATOMIC_RELAXED);
+    }
+    pthread_rwlock_unlock(&shard->lock);
+
+    return result;
+}
+
+PriorityQueueResult pqConcurrentInsertTake(ConcurrentPriorityQueue queue, PQElement element,
+                                           PQElementPriority priority)
+{
+    if (queue == NULL || element == NULL || priority == NULL)
+    {
+        return PQ_NULL_ARGUMENT;
+    }
+
+    Shard shard = lockShardForInsert(queue);
+    PriorityQueueResult result = pqInsertTake(shard->queue, element, priority);
+    if (result == PQ_SUCCESS)
+    {
+        __atomic_fetch_add(&queue->size, 1, __ATOMIC_RELAXED);
+    }
+    pthread_rwlock_unlock(&shard->lock);
+
+    return result;
+}
+
+PQElement pqConcurrentPop(ConcurrentPriorityQueue queue, PQElementPriority* priority)
+{
+    if (queue == NULL)
+    {
+        return NULL;
+    }
+
+    if (queue->order == PQ_ORDER_STRICT || queue->shard_count == 1)
+    {
+        return popStrict(queue, priority);
+    }
+
+    return popRelaxed(queue, priority);
+}
+
+int pqConcurrentGetSize(ConcurrentPriorityQueue queue)
+{
+    if (queue == NULL)
+    {
+        return NULL_INPUT_ERROR;
+    }
+
+    return __atomic_load_n(&queue->size, __ATOMIC_RELAXED);
+}
+
+PQElement pqConcurrentIterBegin(ConcurrentPriorityQueue queue, PQConcurrentIterator* iterator)
+{
+    if (iterator == NULL)
+    {
+        return NULL;
+    }
+
+    iterator->queue = queue;
+    iterator->shard_index = 0;
+    if (queue == NULL)
+    {
+        return NULL;
+    }
+
+    // the shards are always locked by their index order, like in popStrict
+    for (int i = 0; i < queue->shard_count; i++)
+    {
+        lockShardForIteration(&queue->shards[i]);
+    }
+
+    PQElement element = pqIterBegin(queue->shards[0].queue, &iterator->shard_iterator);
+    return element != NULL ? element : pqConcurrentIterNext(iterator);
+}
+
+PQElement pqConcurrentIterNext(PQConcurrentIterator* iterator)
+{
+    if (iterator == NULL || iterator->queue == NULL)
+    {
+        return NULL;
+    }
+
+    PQElement element = pqIterNext(&iterator->shard_iterator);
+    while (element == NULL && iterator->shard_index < iterator->queue->shard_count - 1)
+    {
+        iterator->shard_index++;
+        element = pqIterBegin(iterator->queue->shards[iterator->shard_index].queue, &iterator->shard_iterator);
+    }
+
+    return element;
+}
+
+void pqConcurrentIterEnd(PQConcurrentIterator* iterator)
+{
+    if (iterator == NULL || iterator->queue == NULL)
+    {
+        return;
+    }
+
+    for (int i = iterator->queue->shard_count - 1; i >= 0; i--)
+    {
+        pthread_rwlock_unlock(&iterator->queue->shards[i].lock);
+    }
+
+    pqIterEnd(&iterator->shard_iterator);
+    iterator->queue = NULL;
+}
@@ -0,0 +1,163 @@
+#ifndef CONCURRENT_PRIORITY_QUEUE_H
+#define CONCURRENT_PRIORITY_QUEUE_H
+
+#include "priority_queue.h"
+
+/**
+* Concurrent Priority Queue Container
+*
+* A thread safe priority queue for many producer and consumer threads.
+* The queue is split into shards, each of them a regular priority queue with its own lock
+* (a "multi-queue"). An insert locks only one shard, trying the shards that are not locked first,
+* so producers do not wait for each other.
+* A pop either locks all the shards and takes the exact highest entry (strict order), or looks at
+* two random shards and takes the higher of their first entries (relaxed order). A relaxed pop may
+* return an entry that is not the highest in the queue, but it does not serialise the consumers.
+*
+* Elements and priorities are copied and freed with the given functions, like in the priority queue,
+* and these functions must be safe to call from multiple threads at once.
+*
+* The following functions are available:
+*   pqCreateConcurrent	      - Creates a new empty concurrent priority queue
+*   pqConcurrentDestroy	      - Deletes an existing concurrent priority queue and frees all resources
+*   pqConcurrentInsert	      - Insert an element with a given priority to the queue.
+*   pqConcurrentInsertTake    - Insert an element with a given priority, taking the ownership of them.
+*   pqConcurrentPop           - Removes a highest priority element and returns it to the caller.
+*   pqConcurrentGetSize       - Returns the number of elements in the queue.
+*   pqConcurrentIterBegin     - Starts iterating over a consistent view of the queue.
+*   pqConcurrentIterNext      - Advances the iteration to the next element.
+*   pqConcurrentIterEnd       - Ends the iteration and releases the view.
+*/
+
+/** Type for defining the concurrent priority queue */
+typedef struct ConcurrentPriorityQueue_t *ConcurrentPriorityQueue;
+
+/**
+* Iterator over a concurrent priority queue. May be declared on the stack.
+* The fields are private to the concurrent priority queue.
+*/
+typedef struct PQConcurrentIterator_t {
+    ConcurrentPriorityQueue queue;
+    PQIterator shard_iterator;
+    int shard_index;
+} PQConcurrentIterator;
+
+/** Type used for selecting the order guarantee of pqConcurrentPop */
+typedef enum PQConcurrentOrder_t {
+    PQ_ORDER_STRICT,
+    PQ_ORDER_RELAXED
+} PQConcurrentOrder;
+
+/**
+* pqCreateConcurrent: Allocates a new empty concurrent priority queue.
+* Not thread safe - the queue must be created before it is shared.
+*
+* @param copy_element, free_element, equal_elements, copy_priority, free_priority, compare_priorities -
+*       Same as in pqCreate.
+* @param options - The creation options of every shard (see pqCreateWithOptions), or NULL for the defaults.
+*       Bounded shards (capacity) are not supported.
+* @param shard_count - The number of shards. 0 selects the default (8).
+*       About twice the number of threads that use the queue is a good value.
+* @param order - The order guarantee of pqConcurrentPop.
+* @return
+* 	NULL - if one of the function parameters is NULL, a parameter is illegal or allocations failed.
+* 	A new concurrent priority queue in case of success.
+*/
+ConcurrentPriorityQueue pqCreateConcurrent(CopyPQElement copy_element,
+                                           FreePQElement free_element,
+                                           EqualPQElements equal_elements,
+                                           CopyPQElementPriority copy_priority,
+                                           FreePQElementPriority free_priority,
+                                           ComparePQElementPriorities compare_priorities,
+                                           const PQOptions* options,
+                                           int shard_count,
+                                           PQConcurrentOrder order);
+
+/**
+* pqConcurrentDestroy: Deallocates an existing concurrent priority queue. Clears all elements by using the
+* free functions. Not thread safe - no other thread may use the queue.
+*
+* @param queue - Target queue to be deallocated. If queue is NULL nothing will be done
+*/
+void pqConcurrentDestroy(ConcurrentPriorityQueue queue);
+
+/**
+* pqConcurrentInsert: add a copy of element with a copy of priority to the queue.
+*
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters
+* 	PQ_OUT_OF_MEMORY if an allocation failed
+* 	PQ_SUCCESS the paired elements had been inserted successfully
+*/
+PriorityQueueResult pqConcurrentInsert(ConcurrentPriorityQueue queue, PQElement element,
+                                       PQElementPriority priority);
+
+/**
+* pqConcurrentInsertTake: add element with priority to the queue without copying them,
+* like pqInsertTake.
+*
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters
+* 	PQ_OUT_OF_MEMORY if an allocation failed. The caller keeps the ownership in that case.
+* 	PQ_SUCCESS the paired elements had been inserted successfully
+*/
+PriorityQueueResult pqConcurrentInsertTake(ConcurrentPriorityQueue queue, PQElement element,
+                                           PQElementPriority priority);
+
+/**
+* pqConcurrentPop: Removes a highest priority element from the queue and returns it, like pqPop.
+* With PQ_ORDER_STRICT this is the highest element of the queue (the first inserted between equal
+* priorities), and with PQ_ORDER_RELAXED it is the higher of the first elements of two random shards.
+*
+* @param queue - The queue to remove the element from.
+* @param priority - Pointer to assign the priority of the removed element into.
+*       If NULL, the priority is freed with the free function of the queue.
+* @return
+* 	NULL if a NULL was sent as queue or the queue is empty.
+* 	The removed element otherwise. The caller is responsible for freeing it.
+*/
+PQElement pqConcurrentPop(ConcurrentPriorityQueue queue, PQElementPriority* priority);
+
+/**
+* pqConcurrentGetSize: Returns the number of elements in the queue.
+* While other threads change the queue, the result is a snapshot that may already be outdated.
+*
+* @return
+* 	-1 if a NULL pointer was sent.
+* 	Otherwise the number of elements in the queue.
+*/
+int pqConcurrentGetSize(ConcurrentPriorityQueue queue);
+
+/**
+* pqConcurrentIterBegin: Starts iterating over the queue and returns the first element.
+* From pqConcurrentIterBegin until pqConcurrentIterEnd the queue is a consistent view: other threads
+* may iterate over it at the same time, but inserts and pops wait until every iteration ends.
+* The elements are returned shard after shard, each shard in the queue order, so the whole iteration
+* is not in the queue order. pqConcurrentIterEnd must be called for every pqConcurrentIterBegin,
+* and the iterating thread must not change the queue before it.
+*
+* @param queue - The queue to iterate over.
+* @param iterator - The iterator to start.
+* @return
+* 	NULL if a NULL pointer was sent or the queue is empty.
+* 	The first element of the iteration otherwise.
+*/
+PQElement pqConcurrentIterBegin(ConcurrentPriorityQueue queue, PQConcurrentIterator* iterator);
+
+/**
+* pqConcurrentIterNext: Advances the iterator to the next element and returns it.
+*
+* @return
+* 	NULL if reached the end of the queue, or a NULL sent as argument.
+* 	The next element of the iteration otherwise.
+*/
+PQElement pqConcurrentIterNext(PQConcurrentIterator* iterator);
+
+/**
+* pqConcurrentIterEnd: Ends the iteration and lets other threads change the queue again.
+*
+* @param iterator - The iterator to end. If NULL or already ended nothing will be done
+*/
+void pqConcurrentIterEnd(PQConcurrentIterator* iterator);
+
+#endif /* CONCURRENT_PRIORITY_QUEUE_H */
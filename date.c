@@ -1,17 +1,36 @@
 #include <stdlib.h>
 #include <stdbool.h>
+#include <limits.h>
 #include "date.h"
 
 #define MIN_DAY 1
 #define MAX_DAY 30
+#define DAYS_IN_YEAR (MAX_DAY * NUM_OF_MONTHS)
+#define INITIAL_BUCKET_COUNT 16
+#define MAX_LOAD_FACTOR 1
 enum months{JAN,FEB,MAR,APR,MAY,JUN,JUL,AUG,SEP,OCT,NOV,DEC,NUM_OF_MONTHS};
 
 
-struct Date_t 
+struct Date_t
 {
-    int day;
-    enum months month;
-    int year;
+    DateSerial serial;
+    bool is_shared; // a date of a DatePool, that is the date of a PooledDate
+};
+
+/** A date shared by a DatePool, with the bookkeeping that only the dates of a pool need */
+typedef struct PooledDate_t
+{
+    struct Date_t date;
+    int ref_count;
+    DatePool pool; // NULL once the pool was destroyed
+    struct PooledDate_t* hash_next;
+} *PooledDate;
+
+struct DatePool_t
+{
+    PooledDate* buckets;
+    int bucket_count;
+    int size;
 };
 
 // Function for checking that the date's values are valid
@@ -20,34 +39,301 @@ static bool isValid(int day, int month, int year)
     return (day >= MIN_DAY && day <= MAX_DAY && month >= JAN && month <= DEC);
 }
 
-Date dateCreate(int day, int month, int year)
+// Returns the number of days from 1/1/0 to the date, which may be out of the range of a DateSerial
+static long long getDayNumber(int day, int month, int year)
 {
-    if (!isValid(day,month-1,year))
+    return (long long)year * DAYS_IN_YEAR + month * MAX_DAY + (day - MIN_DAY);
+}
+
+bool dateSerialCreate(int day, int month, int year, DateSerial* serial)
+{
+    if (serial == NULL || !isValid(day,month-1,year))
     {
-        return NULL;
+        return false;
+    }
+
+    long long day_number = getDayNumber(day,month-1,year);
+    if (day_number < INT32_MIN || day_number > INT32_MAX)
+    {
+        return false;
+    }
+
+    *serial = (DateSerial)day_number;
+    return true;
+}
+
+bool dateSerialGet(DateSerial serial, int* day, int* month, int* year)
+{
+    if (day == NULL || month == NULL || year == NULL)
+    {
+        return false;
     }
 
-    // Create new date
+    // Round the year down, so the days before year 0 get a day and a month in range
+    long long day_number = serial;
+    long long year_number = day_number / DAYS_IN_YEAR;
+    if (day_number % DAYS_IN_YEAR < 0)
+    {
+        year_number--;
+    }
+    int day_of_year = (int)(day_number - year_number * DAYS_IN_YEAR);
+
+    *day = day_of_year % MAX_DAY + MIN_DAY;
+    *month = day_of_year / MAX_DAY + 1;
+    *year = (int)year_number;
+
+    return true;
+}
+
+bool dateSerialAddDays(DateSerial serial, int days, DateSerial* result)
+{
+    long long day_number = (long long)serial + days;
+    if (result == NULL || day_number < INT32_MIN || day_number > INT32_MAX)
+    {
+        return false;
+    }
+
+    *result = (DateSerial)day_number;
+    return true;
+}
+
+bool dateToSerial(Date date, DateSerial* serial)
+{
+    if (date == NULL || serial == NULL)
+    {
+        return false;
+    }
+
+    *serial = date->serial;
+    return true;
+}
+
+Date dateFromSerial(DateSerial serial)
+{
     Date date = (Date)malloc(sizeof(struct Date_t));
     if (date == NULL)
     {
         return NULL;
     }
-    
-    // Assign values
-    date->day = day;
-    date->month = month-1;
-    date->year = year;
 
+    date->serial = serial;
+    date->is_shared = false;
     return date;
 }
 
+// Spreads the bits of the serial, so the following days use all the buckets
+static int bucketIndex(DatePool pool, DateSerial serial)
+{
+    unsigned int hash_value = (unsigned int)serial;
+    hash_value ^= hash_value >> 16;
+    hash_value *= 0x45d9f3bu;
+    hash_value ^= hash_value >> 16;
+    return (int)(hash_value & (unsigned int)(pool->bucket_count - 1));
+}
+
+static void growPool(DatePool pool)
+{
+    int new_bucket_count = pool->bucket_count * 2;
+    PooledDate* new_buckets = (PooledDate*)calloc(new_bucket_count, sizeof(PooledDate));
+    if (new_buckets == NULL)
+    {
+        return;
+    }
+
+    PooledDate* old_buckets = pool->buckets;
+    int old_bucket_count = pool->bucket_count;
+    pool->buckets = new_buckets;
+    pool->bucket_count = new_bucket_count;
+
+    for (int i = 0; i < old_bucket_count; i++)
+    {
+        PooledDate pooled = old_buckets[i];
+        while (pooled != NULL)
+        {
+            PooledDate next_pooled = pooled->hash_next;
+            int index = bucketIndex(pool, pooled->date.serial);
+            pooled->hash_next = new_buckets[index];
+            new_buckets[index] = pooled;
+            pooled = next_pooled;
+        }
+    }
+
+    free(old_buckets);
+}
+
+static void removeFromPool(DatePool pool, PooledDate pooled)
+{
+    PooledDate* link = &pool->buckets[bucketIndex(pool, pooled->date.serial)];
+    while (*link != pooled)
+    {
+        link = &(*link)->hash_next;
+    }
+
+    *link = pooled->hash_next;
+    pool->size--;
+}
+
+static Date takeReference(PooledDate pooled)
+{
+    if (pooled->ref_count == INT_MAX)
+    {
+        return NULL;
+    }
+
+    pooled->ref_count++;
+    return &pooled->date;
+}
+
+// Returns the shared date of a serial with one more reference, adding it to the pool if needed
+static Date getSharedDate(DatePool pool, DateSerial serial)
+{
+    int index = bucketIndex(pool, serial);
+    for (PooledDate pooled = pool->buckets[index]; pooled != NULL; pooled = pooled->hash_next)
+    {
+        if (pooled->date.serial == serial)
+        {
+            return takeReference(pooled);
+        }
+    }
+
+    PooledDate pooled = (PooledDate)malloc(sizeof(struct PooledDate_t));
+    if (pooled == NULL)
+    {
+        return NULL;
+    }
+
+    pooled->date.serial = serial;
+    pooled->date.is_shared = true;
+    pooled->ref_count = 1;
+    pooled->pool = pool;
+    pooled->hash_next = pool->buckets[index];
+    pool->buckets[index] = pooled;
+    pool->size++;
+    if (pool->size > pool->bucket_count * MAX_LOAD_FACTOR)
+    {
+        growPool(pool);
+    }
+
+    return &pooled->date;
+}
+
+DatePool datePoolCreate(void)
+{
+    DatePool pool = (DatePool)malloc(sizeof(struct DatePool_t));
+    if (pool == NULL)
+    {
+        return NULL;
+    }
+
+    pool->buckets = (PooledDate*)calloc(INITIAL_BUCKET_COUNT, sizeof(PooledDate));
+    if (pool->buckets == NULL)
+    {
+        free(pool);
+        return NULL;
+    }
+
+    pool->bucket_count = INITIAL_BUCKET_COUNT;
+    pool->size = 0;
+    return pool;
+}
+
+void datePoolDestroy(DatePool pool)
+{
+    if (pool == NULL)
+    {
+        return;
+    }
+
+    // The dates that are still referenced stay shared, without a pool to leave
+    for (int i = 0; i < pool->bucket_count; i++)
+    {
+        PooledDate pooled = pool->buckets[i];
+        while (pooled != NULL)
+        {
+            PooledDate next_pooled = pooled->hash_next;
+            pooled->pool = NULL;
+            pooled->hash_next = NULL;
+            pooled = next_pooled;
+        }
+    }
+
+    free(pool->buckets);
+    free(pool);
+}
+
+Date datePoolGet(DatePool pool, int day, int month, int year)
+{
+    DateSerial serial;
+    if (pool == NULL || !dateSerialCreate(day,month,year,&serial))
+    {
+        return NULL;
+    }
+
+    return getSharedDate(pool, serial);
+}
+
+Date datePoolIntern(DatePool pool, Date date)
+{
+    if (pool == NULL || date == NULL)
+    {
+        return NULL;
+    }
+
+    if (date->is_shared && ((PooledDate)date)->pool == pool)
+    {
+        return takeReference((PooledDate)date);
+    }
+
+    return getSharedDate(pool, date->serial);
+}
+
+int datePoolGetSize(DatePool pool)
+{
+    if (pool == NULL)
+    {
+        return -1;
+    }
+
+    return pool->size;
+}
+
+Date dateCreate(int day, int month, int year)
+{
+    DateSerial serial;
+    if (!dateSerialCreate(day,month,year,&serial))
+    {
+        return NULL;
+    }
+
+    return dateFromSerial(serial);
+}
+
 void dateDestroy(Date date)
 {
-    if (date != NULL)
+    if (date == NULL)
+    {
+        return;
+    }
+
+    if (!date->is_shared)
     {
         free(date);
+        return;
     }
+
+    // A shared date is the date of its PooledDate, that is freed with the last reference
+    PooledDate pooled = (PooledDate)date;
+    if (pooled->ref_count > 1)
+    {
+        pooled->ref_count--;
+        return;
+    }
+
+    if (pooled->pool != NULL)
+    {
+        removeFromPool(pooled->pool, pooled);
+    }
+    free(pooled);
 }
 
 Date dateCopy(Date date)
@@ -56,66 +342,59 @@ Date dateCopy(Date date)
     {
         return NULL;
     }
-    
-    // Create a new date with the same values
-    return dateCreate(date->day,date->month+1,date->year);
+
+    // Create a new date with the same serial, that can change also when date is shared by a pool
+    return dateFromSerial(date->serial);
 }
 
 bool dateGet(Date date, int* day, int* month, int* year)
 {
-    if (date == NULL || day == NULL || month == NULL || year == NULL)
+    if (date == NULL)
     {
         return false;
     }
 
-    // Assign date's values to the given pointers
-    *day = date->day;
-    *month = date->month + 1;
-    *year = date->year;
-    
-    return true;
+    return dateSerialGet(date->serial,day,month,year);
 }
 
 int dateCompare(Date date1, Date date2)
 {
-    if (date1 == NULL || date2 == NULL || (date1->year == date2->year && date1->month == date2->month && date1->day == date2->day))
-    { // input is null or dates are equal
+    if (date1 == NULL || date2 == NULL || date1 == date2)
+    { // input is null or the dates are the same date
         return 0;
     }
-    
-    if (date1->year > date2->year || (date1->year == date2->year && date1->month > date2->month) 
-            || (date1->year == date2->year && date1->month == date2->month && date1->day > date2->day))
-    {// date1 is later than date2
-        return 1;
-    }
-    
-    // date1 is earlier than date2
-    return -1;
+
+    return dateSerialCompare(date1->serial,date2->serial);
 }
 
 void dateTick(Date date)
 {
-    if (date == NULL)
-    {
+    if (date == NULL || date->is_shared || date->serial == INT32_MAX)
+    { // a shared date is immutable, and the last date that a serial holds has no next day
         return;
     }
-    
-    if (date->day == MAX_DAY)
-    { // End of the month
-        date->day = MIN_DAY;
 
-        if (date->month == DEC)
-        { // End of the year
-            date->month = JAN;
-            date->year++;
-        }
-        else
-        {
-            date->month++;
-        }
+    // The next day of the last day of a month (or of a year) is the next serial as well
+    date->serial++;
+}
+
+bool dateAddDays(Date date, int days)
+{
+    if (date == NULL || date->is_shared)
+    {
+        return false;
     }
-    else
-    { // Regular 'tick'
-        date->day++;
+
+    // Every month has the same number of days, so moving a date is adding to its serial
+    return dateSerialAddDays(date->serial,days,&date->serial);
+}
+
+long long dateDiffDays(Date date1, Date date2)
+{
+    if (date1 == NULL || date2 == NULL)
+    {
+        return 0;
     }
-}
\ No newline at end of file
+
+    return (long long)date1->serial - date2->serial;
+}
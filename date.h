@@ -2,10 +2,27 @@
 #define DATE_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 
 /** Type for defining the date */
 typedef struct Date_t *Date;
 
+/**
+* Type for an interning pool of dates. A pool keeps one shared Date for every date that is taken from
+* it, so equal dates from the same pool are the same pointer. A shared date is immutable: dateTick and
+* dateAddDays do not change it, and dateDestroy drops one reference and frees the date with the last one.
+* Only datePoolGet and datePoolIntern share a date: dateCopy of a shared date returns a new date that
+* can change, like the copy of any other date.
+*/
+typedef struct DatePool_t *DatePool;
+
+/**
+* Value type of a date: the number of days from 1/1/0, where every month has 30 days and every year
+* 12 months. A later date has a larger serial, so dates compare with <, == and >, and a date needs no
+* allocation. Every DateSerial is a legal date.
+*/
+typedef int32_t DateSerial;
+
 /**
 * dateCreate: Allocates a new date.
 *
@@ -13,20 +30,21 @@ typedef struct Date_t *Date;
 * @param month - the month of the date.
 * @param year - the year of the date.
 * @return
-* 	NULL - if allocation failed or date is illegal.
+* 	NULL - if allocation failed or date is illegal (including a year that a DateSerial cannot hold).
 * 	A new Date in case of success.
 */
 Date dateCreate(int day, int month, int year);
 
 /**
-* dateDestroy: Deallocates an existing Date.
+* dateDestroy: Deallocates an existing Date. A date shared by a DatePool is deallocated with its last reference.
 *
 * @param date - Target date to be deallocated. If priority queue is NULL nothing will be done
 */
 void dateDestroy(Date date);
 
 /**
-* dateCopy: Creates a copy of target Date.
+* dateCopy: Creates a copy of target Date. The copy is a new date that can change, also when target
+* Date is shared by a DatePool.
 *
 * @param date - Target Date.
 * @return
@@ -50,7 +68,8 @@ Date dateCopy(Date date);
 bool dateGet(Date date, int* day, int* month, int* year);
 
 /**
-* dateCompare: compares to dates and return which comes first
+* dateCompare: compares to dates and return which comes first. The same date (like two dates taken from
+* a DatePool with the same day, month and year) is equal without reading it.
 *
 * @return
 * 		A negative integer if date1 occurs first;
@@ -60,11 +79,154 @@ bool dateGet(Date date, int* day, int* month, int* year);
 int dateCompare(Date date1, Date date2);
 
 /**
-* dateTick: increases the date by one day, if date is NULL should do nothing.
+* dateTick: increases the date by one day, if date is NULL or shared by a DatePool should do nothing.
 *
 * @param date - Target Date
 *
 */
 void dateTick(Date date);
 
+/**
+* dateAddDays: moves the date by a number of days in O(1), like calling dateTick days times.
+*
+* @param date - Target Date
+* @param days - the number of days to add. A negative number moves the date back.
+* @return
+* 	false if date is NULL, is shared by a DatePool, or the new date is out of the range of a DateSerial.
+* 	The date is not changed in that case.
+* 	Otherwise true.
+*/
+bool dateAddDays(Date date, int days);
+
+/**
+* dateDiffDays: returns the number of days between two dates, with the same sign as dateCompare.
+*
+* @return
+* 		The number of days from date2 to date1: negative if date1 occurs first;
+* 		0 if they're equal or one of the given dates is NULL.
+*/
+long long dateDiffDays(Date date1, Date date2);
+
+/**
+* dateSerialCreate: Encodes a date as a DateSerial, without allocating.
+*
+* @param day - the day of the date.
+* @param month - the month of the date.
+* @param year - the year of the date.
+* @param serial - the pointer to assign the serial of the date into.
+* @return
+* 	false if serial is NULL or the date is illegal (including a year that a DateSerial cannot hold).
+* 	Otherwise true and the serial is assigned to the pointer.
+*/
+bool dateSerialCreate(int day, int month, int year, DateSerial* serial);
+
+/**
+* dateSerialGet: Returns the day, month and year of a DateSerial, like dateGet.
+*
+* @return
+* 	false if one of pointers is NULL.
+* 	Otherwise true and the date is assigned to the pointers.
+*/
+bool dateSerialGet(DateSerial serial, int* day, int* month, int* year);
+
+/**
+* dateSerialCompare: compares two serials like dateCompare.
+*
+* @return
+* 		A negative integer if serial1 occurs first;
+* 		0 if they're equal;
+*		A positive integer if serial1 arrives after serial2.
+*/
+static inline int dateSerialCompare(DateSerial serial1, DateSerial serial2)
+{
+    return (serial1 > serial2) - (serial1 < serial2);
+}
+
+/**
+* dateSerialAddDays: adds a number of days to a serial, like dateAddDays.
+*
+* @param serial - the serial of the date.
+* @param days - the number of days to add. A negative number moves the date back.
+* @param result - the pointer to assign the serial of the new date into.
+* @return
+* 	false if result is NULL or the new date is out of the range of a DateSerial.
+* 	Otherwise true and the new serial is assigned to the pointer.
+*/
+bool dateSerialAddDays(DateSerial serial, int days, DateSerial* result);
+
+/**
+* dateToSerial: Returns the DateSerial of a Date.
+*
+* @param date - Target Date.
+* @param serial - the pointer to assign the serial of the date into.
+* @return
+* 	false if one of the arguments is NULL.
+* 	Otherwise true and the serial is assigned to the pointer.
+*/
+bool dateToSerial(Date date, DateSerial* serial);
+
+/**
+* dateFromSerial: Allocates a new Date from a DateSerial.
+*
+* @param serial - the serial of the date.
+* @return
+* 	NULL - if allocation failed.
+* 	A new Date in case of success.
+*/
+Date dateFromSerial(DateSerial serial);
+
+/**
+* datePoolCreate: Allocates a new empty date pool.
+*
+* @return
+* 	NULL - if allocation failed.
+* 	A new DatePool in case of success.
+*/
+DatePool datePoolCreate(void);
+
+/**
+* datePoolDestroy: Deallocates an existing DatePool. The dates taken from it stay valid and immutable
+* until their last reference is destroyed.
+*
+* @param pool - Target pool to be deallocated. If pool is NULL nothing will be done
+*/
+void datePoolDestroy(DatePool pool);
+
+/**
+* datePoolGet: Returns the shared date of the pool with a given day, month and year, with one more
+* reference. The caller releases the reference with dateDestroy.
+*
+* @param pool - Target pool.
+* @param day - the day of the date.
+* @param month - the month of the date.
+* @param year - the year of the date.
+* @return
+* 	NULL - if pool is NULL, allocation failed, date is illegal or the shared date has INT_MAX references.
+* 	The shared date in case of success.
+*/
+Date datePoolGet(DatePool pool, int day, int month, int year);
+
+/**
+* datePoolIntern: Returns the shared date of the pool that is equal to a given date, like datePoolGet.
+* The given date is not changed, and the caller keeps its reference to it. Interning a date of the pool
+* returns the same date with one more reference.
+*
+* @param pool - Target pool.
+* @param date - Target Date.
+* @return
+* 	NULL - if a NULL was sent, allocation failed or the shared date has INT_MAX references.
+* 	The shared date in case of success.
+*/
+Date datePoolIntern(DatePool pool, Date date);
+
+/**
+* datePoolGetSize: Returns the number of different dates that the pool shares.
+*
+* @param pool - Target pool.
+* @return
+* 	-1 if a NULL pointer was sent.
+* 	Otherwise the number of dates in the pool.
+*/
+int datePoolGetSize(DatePool pool);
+
 #endif //DATE_H_
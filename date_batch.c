@@ -0,0 +1,328 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "date_batch.h"
+
+#define BITS_IN_BYTE 8
+#define FILTER_CHUNK_SIZE 256
+
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(DATE_BATCH_DISABLE_SIMD)
+#define DATE_BATCH_X86_64
+#include <immintrin.h>
+#endif
+
+static DateBatchKernel selected_kernel = DATE_BATCH_KERNEL_AUTO;
+
+/**
+* Every operation has a SIMD function that handles the dates in whole vectors and returns how many
+* dates it handled, and a scalar function that handles the rest of them. The filters handle 8 dates
+* at a time, so every byte of the bitmap comes from one of them.
+*/
+
+static void compareScalar(const DateSerial* first, const DateSerial* second, int start, int count, int* results)
+{
+    for (int i = start; i < count; i++)
+    {
+        results[i] = dateSerialCompare(first[i], second[i]);
+    }
+}
+
+static void filterScalar(const DateSerial* dates, int start, int count, DateSerial low, DateSerial high,
+                         uint8_t* bitmap)
+{
+    for (int i = start; i < count; i++)
+    {
+        if (i % BITS_IN_BYTE == 0)
+        {
+            bitmap[i / BITS_IN_BYTE] = 0;
+        }
+        if (dates[i] >= low && dates[i] <= high)
+        {
+            bitmap[i / BITS_IN_BYTE] |= (uint8_t)(1u << (i % BITS_IN_BYTE));
+        }
+    }
+}
+
+static void minMaxScalar(const DateSerial* dates, int start, int count, DateSerial* min, DateSerial* max)
+{
+    for (int i = start; i < count; i++)
+    {
+        *min = dates[i] < *min ? dates[i] : *min;
+        *max = dates[i] > *max ? dates[i] : *max;
+    }
+}
+
+#ifdef DATE_BATCH_X86_64
+
+// SSE2 is a part of x86-64, so only AVX2 has to be checked at run time
+static bool hasAvx2(void)
+{
+    return __builtin_cpu_supports("avx2");
+}
+
+static DateBatchKernel getKernel(void)
+{
+    if (selected_kernel == DATE_BATCH_KERNEL_AUTO)
+    {
+        return hasAvx2() ? DATE_BATCH_KERNEL_AVX2 : DATE_BATCH_KERNEL_SSE2;
+    }
+    return selected_kernel;
+}
+
+__attribute__((target("avx2")))
+static int compareAvx2(const DateSerial* first, const DateSerial* second, int count, int* results)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i first_dates = _mm256_loadu_si256((const __m256i*)(first + i));
+        __m256i second_dates = _mm256_loadu_si256((const __m256i*)(second + i));
+        // a true comparison is -1, so (first < second) - (first > second) gives 1, 0 or -1 like dateSerialCompare
+        __m256i result = _mm256_sub_epi32(_mm256_cmpgt_epi32(second_dates, first_dates),
+                                          _mm256_cmpgt_epi32(first_dates, second_dates));
+        _mm256_storeu_si256((__m256i*)(results + i), result);
+    }
+    return i;
+}
+
+static int compareSse2(const DateSerial* first, const DateSerial* second, int count, int* results)
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i first_dates = _mm_loadu_si128((const __m128i*)(first + i));
+        __m128i second_dates = _mm_loadu_si128((const __m128i*)(second + i));
+        __m128i result = _mm_sub_epi32(_mm_cmpgt_epi32(second_dates, first_dates),
+                                       _mm_cmpgt_epi32(first_dates, second_dates));
+        _mm_storeu_si128((__m128i*)(results + i), result);
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static int filterAvx2(const DateSerial* dates, int count, DateSerial low, DateSerial high, uint8_t* bitmap)
+{
+    __m256i low_dates = _mm256_set1_epi32(low);
+    __m256i high_dates = _mm256_set1_epi32(high);
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i current_dates = _mm256_loadu_si256((const __m256i*)(dates + i));
+        __m256i out_of_range = _mm256_or_si256(_mm256_cmpgt_epi32(low_dates, current_dates),
+                                               _mm256_cmpgt_epi32(current_dates, high_dates));
+        bitmap[i / BITS_IN_BYTE] = (uint8_t)~_mm256_movemask_ps(_mm256_castsi256_ps(out_of_range));
+    }
+    return i;
+}
+
+static int getOutOfRangeMaskSse2(const DateSerial* dates, __m128i low_dates, __m128i high_dates)
+{
+    __m128i current_dates = _mm_loadu_si128((const __m128i*)dates);
+    __m128i out_of_range = _mm_or_si128(_mm_cmpgt_epi32(low_dates, current_dates),
+                                        _mm_cmpgt_epi32(current_dates, high_dates));
+    return _mm_movemask_ps(_mm_castsi128_ps(out_of_range));
+}
+
+static int filterSse2(const DateSerial* dates, int count, DateSerial low, DateSerial high, uint8_t* bitmap)
+{
+    __m128i low_dates = _mm_set1_epi32(low);
+    __m128i high_dates = _mm_set1_epi32(high);
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        // two vectors of 4 dates make one byte of the bitmap
+        int out_of_range = getOutOfRangeMaskSse2(dates + i, low_dates, high_dates) |
+                           getOutOfRangeMaskSse2(dates + i + 4, low_dates, high_dates) << 4;
+        bitmap[i / BITS_IN_BYTE] = (uint8_t)~out_of_range;
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static int minMaxAvx2(const DateSerial* dates, int count, DateSerial* min, DateSerial* max)
+{
+    if (count < 8)
+    {
+        return 0;
+    }
+
+    __m256i min_dates = _mm256_loadu_si256((const __m256i*)dates);
+    __m256i max_dates = min_dates;
+    int i = 8;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i current_dates = _mm256_loadu_si256((const __m256i*)(dates + i));
+        min_dates = _mm256_min_epi32(min_dates, current_dates);
+        max_dates = _mm256_max_epi32(max_dates, current_dates);
+    }
+
+    DateSerial lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, min_dates);
+    minMaxScalar(lanes, 0, 8, min, max);
+    _mm256_storeu_si256((__m256i*)lanes, max_dates);
+    minMaxScalar(lanes, 0, 8, min, max);
+    return i;
+}
+
+// SSE2 has no 32 bit min and max, so they select by a comparison mask
+static __m128i selectSse2(__m128i mask, __m128i if_set, __m128i if_clear)
+{
+    return _mm_or_si128(_mm_and_si128(mask, if_set), _mm_andnot_si128(mask, if_clear));
+}
+
+static int minMaxSse2(const DateSerial* dates, int count, DateSerial* min, DateSerial* max)
+{
+    if (count < 4)
+    {
+        return 0;
+    }
+
+    __m128i min_dates = _mm_loadu_si128((const __m128i*)dates);
+    __m128i max_dates = min_dates;
+    int i = 4;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i current_dates = _mm_loadu_si128((const __m128i*)(dates + i));
+        min_dates = selectSse2(_mm_cmpgt_epi32(min_dates, current_dates), current_dates, min_dates);
+        max_dates = selectSse2(_mm_cmpgt_epi32(current_dates, max_dates), current_dates, max_dates);
+    }
+
+    DateSerial lanes[4];
+    _mm_storeu_si128((__m128i*)lanes, min_dates);
+    minMaxScalar(lanes, 0, 4, min, max);
+    _mm_storeu_si128((__m128i*)lanes, max_dates);
+    minMaxScalar(lanes, 0, 4, min, max);
+    return i;
+}
+
+#endif
+
+// Returns the index of the lowest set bit of bits, that must not be 0
+static int getLowestBit(unsigned int bits)
+{
+#if defined(__GNUC__)
+    return __builtin_ctz(bits);
+#else
+    int bit = 0;
+    while ((bits & (1u << bit)) == 0)
+    {
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+bool dateCompareBatch(const DateSerial* first, const DateSerial* second, int count, int* results)
+{
+    if (first == NULL || second == NULL || results == NULL || count < 0)
+    {
+        return false;
+    }
+
+    int start = 0;
+#ifdef DATE_BATCH_X86_64
+    DateBatchKernel kernel = getKernel();
+    if (kernel == DATE_BATCH_KERNEL_AVX2)
+    {
+        start = compareAvx2(first, second, count, results);
+    }
+    else if (kernel == DATE_BATCH_KERNEL_SSE2)
+    {
+        start = compareSse2(first, second, count, results);
+    }
+#endif
+    compareScalar(first, second, start, count, results);
+    return true;
+}
+
+bool dateFilterRangeBitmap(const DateSerial* dates, int count, DateSerial low, DateSerial high, uint8_t* bitmap)
+{
+    if (dates == NULL || bitmap == NULL || count < 0)
+    {
+        return false;
+    }
+
+    int start = 0;
+#ifdef DATE_BATCH_X86_64
+    DateBatchKernel kernel = getKernel();
+    if (kernel == DATE_BATCH_KERNEL_AVX2)
+    {
+        start = filterAvx2(dates, count, low, high, bitmap);
+    }
+    else if (kernel == DATE_BATCH_KERNEL_SSE2)
+    {
+        start = filterSse2(dates, count, low, high, bitmap);
+    }
+#endif
+    filterScalar(dates, start, count, low, high, bitmap);
+    return true;
+}
+
+int dateFilterRange(const DateSerial* dates, int count, DateSerial low, DateSerial high, int* indices)
+{
+    if (dates == NULL || indices == NULL || count < 0)
+    {
+        return -1;
+    }
+
+    // the dates are filtered a chunk at a time into a bitmap, that turns into indices
+    uint8_t bitmap[FILTER_CHUNK_SIZE / BITS_IN_BYTE];
+    int found_count = 0;
+    for (int chunk_start = 0; chunk_start < count; chunk_start += FILTER_CHUNK_SIZE)
+    {
+        int chunk_size = count - chunk_start < FILTER_CHUNK_SIZE ? count - chunk_start : FILTER_CHUNK_SIZE;
+        dateFilterRangeBitmap(dates + chunk_start, chunk_size, low, high, bitmap);
+
+        for (int byte = 0; byte * BITS_IN_BYTE < chunk_size; byte++)
+        {
+            for (unsigned int bits = bitmap[byte]; bits != 0; bits &= bits - 1)
+            {
+                indices[found_count++] = chunk_start + byte * BITS_IN_BYTE + getLowestBit(bits);
+            }
+        }
+    }
+
+    return found_count;
+}
+
+bool dateMinMax(const DateSerial* dates, int count, DateSerial* min, DateSerial* max)
+{
+    if (dates == NULL || min == NULL || max == NULL || count <= 0)
+    {
+        return false;
+    }
+
+    *min = dates[0];
+    *max = dates[0];
+    int start = 0;
+#ifdef DATE_BATCH_X86_64
+    DateBatchKernel kernel = getKernel();
+    if (kernel == DATE_BATCH_KERNEL_AVX2)
+    {
+        start = minMaxAvx2(dates, count, min, max);
+    }
+    else if (kernel == DATE_BATCH_KERNEL_SSE2)
+    {
+        start = minMaxSse2(dates, count, min, max);
+    }
+#endif
+    minMaxScalar(dates, start, count, min, max);
+    return true;
+}
+
+bool dateBatchSetKernel(DateBatchKernel kernel)
+{
+#ifdef DATE_BATCH_X86_64
+    bool is_available = kernel == DATE_BATCH_KERNEL_AUTO || kernel == DATE_BATCH_KERNEL_SCALAR ||
+                        kernel == DATE_BATCH_KERNEL_SSE2 || (kernel == DATE_BATCH_KERNEL_AVX2 && hasAvx2());
+#else
+    bool is_available = kernel == DATE_BATCH_KERNEL_AUTO || kernel == DATE_BATCH_KERNEL_SCALAR;
+#endif
+    if (!is_available)
+    {
+        return false;
+    }
+
+    selected_kernel = kernel;
+    return true;
+}
@@ -0,0 +1,100 @@
+#ifndef DATE_BATCH_H_
+#define DATE_BATCH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "date.h"
+
+/**
+* Batch operations on contiguous arrays of DateSerial values.
+*
+* On x86-64 they use AVX2 when the processor supports it and SSE2 otherwise, and other platforms use
+* plain loops. Every path gives the same results. Defining DATE_BATCH_DISABLE_SIMD at compile time
+* forces the plain loops, and dateBatchSetKernel selects a path at run time, so tests can check them all.
+*
+* The following functions are available:
+*   dateCompareBatch      - Compares two arrays of dates pair by pair
+*   dateFilterRangeBitmap - Marks the dates of an array that are in a range in a bitmap
+*   dateFilterRange       - Returns the indices of the dates of an array that are in a range
+*   dateMinMax            - Returns the first and the last date of an array
+*   dateBatchSetKernel    - Selects the path that the batch functions use
+*/
+
+/** The paths of the batch functions */
+typedef enum DateBatchKernel_t {
+    DATE_BATCH_KERNEL_AUTO,
+    DATE_BATCH_KERNEL_SCALAR,
+    DATE_BATCH_KERNEL_SSE2,
+    DATE_BATCH_KERNEL_AVX2
+} DateBatchKernel;
+
+/**
+* dateCompareBatch: compares first[i] with second[i] for every i below count, like dateSerialCompare.
+*
+* @param first - the first dates of the pairs.
+* @param second - the second dates of the pairs.
+* @param count - the number of pairs.
+* @param results - an array of count results, to assign the comparison of every pair into:
+* 		-1 if first[i] occurs first, 0 if they're equal and 1 if first[i] arrives after second[i].
+* @return
+* 	false if one of the arrays is NULL or count is negative.
+* 	Otherwise true.
+*/
+bool dateCompareBatch(const DateSerial* first, const DateSerial* second, int count, int* results);
+
+/**
+* dateFilterRangeBitmap: marks which dates are between low and high (both included).
+*
+* @param dates - the dates to filter.
+* @param count - the number of dates.
+* @param low - the first date of the range.
+* @param high - the last date of the range.
+* @param bitmap - an array of (count + 7) / 8 bytes. Bit i % 8 of byte i / 8 is set if dates[i] is in the
+* 		range and cleared otherwise. The bits after the last date are cleared.
+* @return
+* 	false if one of the arrays is NULL or count is negative.
+* 	Otherwise true.
+*/
+bool dateFilterRangeBitmap(const DateSerial* dates, int count, DateSerial low, DateSerial high, uint8_t* bitmap);
+
+/**
+* dateFilterRange: returns the indices of the dates that are between low and high (both included).
+*
+* @param dates - the dates to filter.
+* @param count - the number of dates.
+* @param low - the first date of the range.
+* @param high - the last date of the range.
+* @param indices - an array of count indices, to assign the indices of the dates in the range into,
+* 		in ascending order.
+* @return
+* 	-1 if one of the arrays is NULL or count is negative.
+* 	Otherwise the number of dates in the range.
+*/
+int dateFilterRange(const DateSerial* dates, int count, DateSerial low, DateSerial high, int* indices);
+
+/**
+* dateMinMax: returns the date that occurs first and the date that arrives last in an array.
+*
+* @param dates - the dates.
+* @param count - the number of dates.
+* @param min - the pointer to assign the first date into.
+* @param max - the pointer to assign the last date into.
+* @return
+* 	false if one of the pointers is NULL or count is not positive.
+* 	Otherwise true and the dates are assigned to the pointers.
+*/
+bool dateMinMax(const DateSerial* dates, int count, DateSerial* min, DateSerial* max);
+
+/**
+* dateBatchSetKernel: makes all the batch functions use one path, for testing every path against the
+* plain loops. DATE_BATCH_KERNEL_AUTO, the default, selects the fastest path the processor supports.
+* The selection is global and not thread safe, so it should not change while batch functions run.
+*
+* @param kernel - the path to use.
+* @return
+* 	false if the path is not compiled in or the processor does not support it. The path is not changed.
+* 	Otherwise true.
+*/
+bool dateBatchSetKernel(DateBatchKernel kernel);
+
+#endif //DATE_BATCH_H_
@@ -3,8 +3,81 @@
 #include <stdio.h>
 #include <assert.h>
 #include "date.h"
+#include "date_batch.h"
 
 
+// Returns whether the batch functions give the results of one date at a time on count dates
+static bool checkBatchFunctions(const DateSerial* dates, const DateSerial* other_dates, int count,
+                                DateSerial low, DateSerial high, int* results, uint8_t* bitmap)
+{
+    int found_count = dateFilterRange(dates, count, low, high, results);
+    int expected_count = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (dates[i] >= low && dates[i] <= high)
+        {
+            if (expected_count >= found_count || results[expected_count] != i)
+            {
+                return false;
+            }
+            expected_count++;
+        }
+    }
+    if (found_count != expected_count)
+    {
+        return false;
+    }
+
+    // the bits after the last date are cleared as well
+    memset(bitmap, 0xff, (count + 7) / 8);
+    if (!dateFilterRangeBitmap(dates, count, low, high, bitmap))
+    {
+        return false;
+    }
+    for (int i = 0; i < (count + 7) / 8 * 8; i++)
+    {
+        if (((bitmap[i / 8] >> (i % 8)) & 1) != (i < count && dates[i] >= low && dates[i] <= high))
+        {
+            return false;
+        }
+    }
+
+    if (!dateCompareBatch(dates, other_dates, count, results))
+    {
+        return false;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (results[i] != dateSerialCompare(dates[i], other_dates[i]))
+        {
+            return false;
+        }
+    }
+
+    DateSerial min_date = 0;
+    DateSerial max_date = 0;
+    if (dateMinMax(other_dates, count, &min_date, &max_date) != (count > 0))
+    {
+        return false;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (other_dates[i] < min_date || other_dates[i] > max_date)
+        {
+            return false;
+        }
+    }
+    // the first and the last dates are dates of the array
+    bool has_min = count == 0;
+    bool has_max = count == 0;
+    for (int i = 0; i < count; i++)
+    {
+        has_min = has_min || other_dates[i] == min_date;
+        has_max = has_max || other_dates[i] == max_date;
+    }
+    return has_min && has_max;
+}
+
 int main(int argc, char *argv[]) 
 {
     Date date1 = dateCreate(30,12,2020);
@@ -46,6 +119,164 @@ int main(int argc, char *argv[])
         printf("The 2nd date is: %d/%d/%d\n", *day,*month,*year);
     }
 
+    // Serial dates are values that compare as integers
+    DateSerial serial1 = 0;
+    DateSerial serial2 = 0;
+    if (!dateToSerial(date1,&serial1) || !dateToSerial(date2,&serial2))
+    {
+        return 1;
+    }
+    printf("Serial comparison: %d\n", dateSerialCompare(serial1,serial2));
+    assert(serial1 < serial2 && dateSerialCompare(serial1,serial2) < 0);
+    if (dateSerialGet(serial2,day,month,year))
+    {
+        printf("The 2nd serial date is: %d/%d/%d\n", *day,*month,*year);
+    }
+
+    Date date3 = dateFromSerial(serial1);
+    printf("Comparison of the date from the serial: %d\n", dateCompare(date1,date3));
+    assert(dateCompare(date1,date3) == 0);
+    dateDestroy(date3);
+
+    // The day before 1/1/0 is the last day of year -1
+    DateSerial year_zero = 0;
+    if (dateSerialCreate(1,1,0,&year_zero) && dateSerialGet(year_zero - 1,day,month,year))
+    {
+        printf("The day before 1/1/0 is: %d/%d/%d\n\n", *day,*month,*year);
+    }
+    assert(year_zero == 0 && *day == 30 && *month == 12 && *year == -1);
+
+    // Adding days works like ticking, in both directions
+    Date date4 = dateCopy(date1);
+    for (int i = 0; i < 400; i++)
+    {
+        dateTick(date1);
+    }
+    if (dateAddDays(date4,400) && dateGet(date4,day,month,year))
+    {
+        printf("400 days after 30/12/2020 is: %d/%d/%d\n", *day,*month,*year);
+    }
+    assert(dateCompare(date1,date4) == 0);
+    if (dateAddDays(date4,-401) && dateGet(date4,day,month,year))
+    {
+        printf("401 days before it is: %d/%d/%d\n", *day,*month,*year);
+    }
+    printf("Days between them: %lld\n\n", dateDiffDays(date4,date1));
+    assert(dateDiffDays(date4,date1) == -401 && dateDiffDays(date1,date4) == 401);
+    dateDestroy(date4);
+
+    // The batch functions give the same results as one date at a time, also for the dates after the vectors
+    const int batch_size = 1003;
+    DateSerial* dates = (DateSerial*)malloc(batch_size * sizeof(DateSerial));
+    DateSerial* other_dates = (DateSerial*)malloc(batch_size * sizeof(DateSerial));
+    int* results = (int*)malloc(batch_size * sizeof(int));
+    uint8_t* bitmap = (uint8_t*)malloc((batch_size + 7) / 8);
+    if (dates == NULL || other_dates == NULL || results == NULL || bitmap == NULL)
+    {
+        return 1;
+    }
+
+    srand(0);
+    for (int i = 0; i < batch_size; i++)
+    {
+        dates[i] = serial1 + rand() % 100 - 50;
+        other_dates[i] = serial1 + rand() % 100 - 50;
+    }
+    dates[batch_size - 1] = INT32_MIN;
+
+    // Every path gives the results of one date at a time, for every count of dates after the vectors
+    const char* kernel_names[] = {"auto", "scalar", "SSE2", "AVX2"};
+    DateBatchKernel kernels[] = {DATE_BATCH_KERNEL_AUTO, DATE_BATCH_KERNEL_SCALAR, DATE_BATCH_KERNEL_SSE2,
+                                 DATE_BATCH_KERNEL_AVX2};
+    for (int k = 0; k < 4; k++)
+    {
+        if (!dateBatchSetKernel(kernels[k]))
+        {
+            printf("Batch path %s: not available\n", kernel_names[k]);
+            continue;
+        }
+
+        bool is_same = true;
+        for (int count = 0; count <= batch_size && is_same; count++)
+        {
+            // the dates from start to the end of the array, so the vectors are not aligned either
+            int start = batch_size - count;
+            is_same = checkBatchFunctions(dates + start, other_dates + start, count, serial1 - 10, serial1 + 10,
+                                          results, bitmap);
+        }
+        printf("Batch path %s: %s\n", kernel_names[k], is_same ? "ok" : "failed");
+        assert(is_same);
+    }
+    dateBatchSetKernel(DATE_BATCH_KERNEL_AUTO);
+
+    int found_count = dateFilterRange(dates, batch_size, serial1 - 10, serial1 + 10, results);
+    printf("Dates in range: %d of %d\n", found_count, batch_size);
+
+    DateSerial min_date = 0;
+    DateSerial max_date = 0;
+    if (dateMinMax(other_dates, batch_size, &min_date, &max_date))
+    {
+        printf("First and last dates: %d, %d days from the 1st date\n\n", min_date - serial1, max_date - serial1);
+    }
+    assert(min_date == serial1 - 50 && max_date == serial1 + 49);
+
+    free(dates);
+    free(other_dates);
+    free(results);
+    free(bitmap);
+
+    // A pool shares one immutable date for every day, month and year
+    DatePool pool = datePoolCreate();
+    Date shared1 = datePoolGet(pool,30,12,2020);
+    Date shared2 = datePoolIntern(pool,date2);
+    Date shared3 = datePoolGet(pool,2,1,2021);
+    Date shared4 = datePoolIntern(pool,shared1);
+    printf("Pool size: %d, same dates: %d %d\n", datePoolGetSize(pool), shared2 == shared3, shared1 == shared4);
+    assert(datePoolGetSize(pool) == 2 && shared2 == shared3 && shared1 == shared4 && shared1 != shared2);
+    assert(dateCompare(shared2,date2) == 0 && dateCompare(shared1,shared2) < 0);
+
+    dateTick(shared1);
+    if (dateAddDays(shared1,1))
+    {
+        return 1;
+    }
+    assert(dateCompare(shared1,shared4) == 0 && dateDiffDays(shared2,shared1) == 2);
+
+    // The copy of a shared date is a date of its own, that can change
+    Date private_copy = dateCopy(shared1);
+    dateTick(private_copy);
+    if (!dateAddDays(private_copy,1))
+    {
+        return 1;
+    }
+    assert(private_copy != shared1 && dateCompare(private_copy,shared2) == 0 && dateDiffDays(shared2,shared1) == 2);
+    assert(datePoolGetSize(pool) == 2);
+    dateDestroy(private_copy);
+
+    Date year_dates[360];
+    for (int i = 0; i < 360; i++)
+    {
+        year_dates[i] = datePoolGet(pool,i % 30 + 1,i / 30 + 1,2000);
+    }
+    assert(datePoolGetSize(pool) == 362);
+    for (int i = 0; i < 360; i++)
+    {
+        dateDestroy(year_dates[i]);
+    }
+    dateDestroy(shared2);
+    dateDestroy(shared3);
+    dateDestroy(shared4);
+    printf("Pool size after destroying: %d\n\n", datePoolGetSize(pool));
+    assert(datePoolGetSize(pool) == 1);
+
+    // A date outlives its pool
+    datePoolDestroy(pool);
+    if (dateGet(shared1,day,month,year))
+    {
+        printf("The shared date is: %d/%d/%d\n\n", *day,*month,*year);
+    }
+    dateDestroy(shared1);
+
     dateDestroy(date1);
     dateDestroy(date2);
     printf("ok\n");
@@ -0,0 +1,349 @@
+#include <stdlib.h>
+#include <limits.h>
+#include <assert.h>
+#include "priority_queue.h"
+#include "int_priority_queue.h"
+
+#define NULL_INPUT_ERROR -1
+#define NO_BUCKET -1
+#define MAX_BUCKET_COUNT INT_MAX
+
+/** Type for defining the element node of a bucket */
+typedef struct int_element_t
+{
+    PQElement element_data;
+    int priority;
+    struct int_element_t* next;
+    struct int_element_t* prev;
+} *IntElementNode;
+
+/** The FIFO list of the elements of one priority */
+typedef struct bucket_t
+{
+    IntElementNode first;
+    IntElementNode last;
+} Bucket;
+
+struct IntPriorityQueue_t
+{
+    CopyPQElement copy_element;
+    FreePQElement free_element;
+    EqualPQElements equal_elements;
+    int min_priority;
+    int bucket_count;
+    Bucket* buckets;
+    int top_bucket;
+    IntElementNode free_nodes;
+    int size;
+};
+
+static void linkBucketNode(IntPriorityQueue queue, IntElementNode node)
+{
+    int index = node->priority - queue->min_priority;
+    Bucket* bucket = &queue->buckets[index];
+
+    node->next = NULL;
+    node->prev = bucket->last;
+    if (bucket->last != NULL)
+    {
+        bucket->last->next = node;
+    }
+    else
+    {
+        bucket->first = node;
+    }
+    bucket->last = node;
+
+    if (index > queue->top_bucket)
+    {
+        queue->top_bucket = index;
+    }
+    queue->size++;
+}
+
+static void unlinkBucketNode(IntPriorityQueue queue, IntElementNode node)
+{
+    Bucket* bucket = &queue->buckets[node->priority - queue->min_priority];
+
+    if (node->prev != NULL)
+    {
+        node->prev->next = node->next;
+    }
+    else
+    {
+        bucket->first = node->next;
+    }
+
+    if (node->next != NULL)
+    {
+        node->next->prev = node->prev;
+    }
+    else
+    {
+        bucket->last = node->prev;
+    }
+
+    queue->size--;
+}
+
+/** Returns a node to the free nodes of the queue, without freeing its element */
+static void releaseNode(IntPriorityQueue queue, IntElementNode node)
+{
+    node->next = queue->free_nodes;
+    queue->free_nodes = node;
+}
+
+static IntElementNode getFirstNode(IntPriorityQueue queue)
+{
+    // the buckets above top_bucket are empty, so the scan only goes down
+    while (queue->top_bucket != NO_BUCKET && queue->buckets[queue->top_bucket].first == NULL)
+    {
+        queue->top_bucket--;
+    }
+
+    return queue->top_bucket == NO_BUCKET ? NULL : queue->buckets[queue->top_bucket].first;
+}
+
+static bool isPriorityInRange(IntPriorityQueue queue, int priority)
+{
+    // the difference of two ints may not fit in an int
+    return priority >= queue->min_priority && (long long)priority - queue->min_priority < queue->bucket_count;
+}
+
+IntPriorityQueue ipqCreate(CopyPQElement copy_element, FreePQElement free_element,
+                           EqualPQElements equal_elements, int min_priority, int max_priority)
+{
+    long long bucket_count = (long long)max_priority - min_priority + 1;
+    if (!copy_element || !free_element || !equal_elements || max_priority < min_priority ||
+        bucket_count > MAX_BUCKET_COUNT)
+    {
+        return NULL;
+    }
+
+    IntPriorityQueue new_queue = (IntPriorityQueue)malloc(sizeof(struct IntPriorityQueue_t));
+    if (new_queue == NULL)
+    {
+        return NULL;
+    }
+
+    new_queue->copy_element = copy_element;
+    new_queue->free_element = free_element;
+    new_queue->equal_elements = equal_elements;
+    new_queue->min_priority = min_priority;
+    new_queue->bucket_count = (int)bucket_count;
+    new_queue->top_bucket = NO_BUCKET;
+    new_queue->free_nodes = NULL;
+    new_queue->size = 0;
+    new_queue->buckets = (Bucket*)calloc(new_queue->bucket_count, sizeof(Bucket));
+    if (new_queue->buckets == NULL)
+    {
+        free(new_queue);
+        return NULL;
+    }
+
+    return new_queue;
+}
+
+void ipqDestroy(IntPriorityQueue queue)
+{
+    if (queue == NULL)
+    {
+        return;
+    }
+
+    ipqClear(queue);
+
+    while (queue->free_nodes != NULL)
+    {
+        IntElementNode next_node = queue->free_nodes->next;
+        free(queue->free_nodes);
+        queue->free_nodes = next_node;
+    }
+
+    free(queue->buckets);
+    free(queue);
+}
+
+int ipqGetSize(IntPriorityQueue queue)
+{
+    if (queue == NULL)
+    {
+        return NULL_INPUT_ERROR;
+    }
+
+    return queue->size;
+}
+
+bool ipqContains(IntPriorityQueue queue, PQElement element)
+{
+    if (queue == NULL || element == NULL)
+    {
+        return false;
+    }
+
+    for (int index = queue->top_bucket; index > NO_BUCKET; index--)
+    {
+        for (IntElementNode node = queue->buckets[index].first; node != NULL; node = node->next)
+        {
+            if (queue->equal_elements(node->element_data, element))
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+PriorityQueueResult ipqInsert(IntPriorityQueue queue, PQElement element, int priority)
+{
+    if (queue == NULL || element == NULL)
+    {
+        return PQ_NULL_ARGUMENT;
+    }
+
+    if (!isPriorityInRange(queue, priority))
+    {
+        return PQ_ERROR;
+    }
+
+    IntElementNode node = queue->free_nodes;
+    if (node != NULL)
+    {
+        queue->free_nodes = node->next;
+    }
+    else
+    {
+        node = (IntElementNode)malloc(sizeof(struct int_element_t));
+        if (node == NULL)
+        {
+            return PQ_OUT_OF_MEMORY;
+        }
+    }
+
+    node->element_data = queue->copy_element(element);
+    if (node->element_data == NULL)
+    {
+        releaseNode(queue, node);
+        return PQ_OUT_OF_MEMORY;
+    }
+
+    node->priority = priority;
+    linkBucketNode(queue, node);
+
+    return PQ_SUCCESS;
+}
+
+PriorityQueueResult ipqChangePriority(IntPriorityQueue queue, PQElement element, int old_priority,
+                                      int new_priority)
+{
+    if (queue == NULL || element == NULL)
+    {
+        return PQ_NULL_ARGUMENT;
+    }
+
+    if (!isPriorityInRange(queue, new_priority))
+    {
+        return PQ_ERROR;
+    }
+
+    if (!isPriorityInRange(queue, old_priority))
+    {
+        return PQ_ELEMENT_DOES_NOT_EXISTS;
+    }
+
+    // the bucket is in insertion order, so the first match is the first inserted
+    IntElementNode node = queue->buckets[old_priority - queue->min_priority].first;
+    while (node != NULL && !queue->equal_elements(node->element_data, element))
+    {
+        node = node->next;
+    }
+
+    if (node == NULL)
+    {
+        return PQ_ELEMENT_DOES_NOT_EXISTS;
+    }
+
+    unlinkBucketNode(queue, node);
+    node->priority = new_priority;
+    linkBucketNode(queue, node);
+
+    return PQ_SUCCESS;
+}
+
+PriorityQueueResult ipqRemove(IntPriorityQueue queue)
+{
+    if (queue == NULL)
+    {
+        return PQ_NULL_ARGUMENT;
+    }
+
+    PQElement element = ipqPop(queue, NULL);
+    if (element == NULL)
+    {
+        return PQ_ELEMENT_DOES_NOT_EXISTS;
+    }
+
+    queue->free_element(element);
+    return PQ_SUCCESS;
+}
+
+PQElement ipqPop(IntPriorityQueue queue, int* priority)
+{
+    if (queue == NULL)
+    {
+        return NULL;
+    }
+
+    IntElementNode first_node = getFirstNode(queue);
+    if (first_node == NULL)
+    {
+        return NULL;
+    }
+
+    unlinkBucketNode(queue, first_node);
+    if (priority != NULL)
+    {
+        *priority = first_node->priority;
+    }
+
+    PQElement element = first_node->element_data;
+    releaseNode(queue, first_node);
+    return element;
+}
+
+PQElement ipqGetFirst(IntPriorityQueue queue, int* priority)
+{
+    if (queue == NULL)
+    {
+        return NULL;
+    }
+
+    IntElementNode first_node = getFirstNode(queue);
+    if (first_node == NULL)
+    {
+        return NULL;
+    }
+
+    if (priority != NULL)
+    {
+        *priority = first_node->priority;
+    }
+    return first_node->element_data;
+}
+
+PriorityQueueResult ipqClear(IntPriorityQueue queue)
+{
+    if (queue == NULL)
+    {
+        return PQ_NULL_ARGUMENT;
+    }
+
+    while (queue->size > 0)
+    {
+        ipqRemove(queue);
+    }
+
+    assert(getFirstNode(queue) == NULL);
+    return PQ_SUCCESS;
+}
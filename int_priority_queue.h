@@ -0,0 +1,147 @@
+#ifndef INT_PRIORITY_QUEUE_H
+#define INT_PRIORITY_QUEUE_H
+
+#include <stdbool.h>
+#include "priority_queue.h"
+
+/**
+* Integer Priority Queue Container
+*
+* A priority queue for integer priorities in a bounded range, kept as a bucket queue: every priority
+* of the range has a FIFO list of its elements, and the priorities are stored inline, so there are
+* no priority callbacks. Insert and remove are O(1), and finding the first element scans down from the
+* highest priority that was inserted, which is O(1) amortised when the priorities go down over time
+* (a monotone queue) and O(range) at worst otherwise.
+* Like the priority queue, the highest priority comes first, and between equal priorities the
+* element that was inserted first comes first.
+*
+* The following functions are available:
+*   ipqCreate           - Creates a new empty integer priority queue for a range of priorities
+*   ipqDestroy          - Deletes an existing queue and frees all resources
+*   ipqGetSize          - Returns the size of a given queue
+*   ipqContains         - Returns whether or not an element exists inside the queue.
+*   ipqInsert           - Insert an element with a given priority to the queue.
+*   ipqChangePriority   - Changes the priority of an element with specific priority
+*   ipqRemove           - Removes the highest priority element in the queue
+*   ipqPop              - Removes the highest priority element and returns it to the caller.
+*   ipqGetFirst         - Returns the highest priority element in the queue and its priority.
+*   ipqClear            - Clears the contents of the queue.
+*/
+
+/** Type for defining the integer priority queue */
+typedef struct IntPriorityQueue_t *IntPriorityQueue;
+
+/**
+* ipqCreate: Allocates a new empty integer priority queue.
+*
+* @param copy_element - Function pointer to be used for copying data elements into the queue
+*       or when copying the queue.
+* @param free_element - Function pointer to be used for removing data elements from the queue
+* @param equal_elements - Function pointer to be used for comparing elements in the queue.
+* @param min_priority - The lowest priority the queue accepts.
+* @param max_priority - The highest priority the queue accepts.
+* @return
+* 	NULL - if one of the function parameters is NULL, max_priority is lower than min_priority,
+* 	the range has more than INT_MAX priorities or allocations failed.
+* 	A new integer priority queue in case of success.
+*/
+IntPriorityQueue ipqCreate(CopyPQElement copy_element, FreePQElement free_element,
+                           EqualPQElements equal_elements, int min_priority, int max_priority);
+
+/**
+* ipqDestroy: Deallocates an existing queue. Clears all elements by using the free function.
+*
+* @param queue - Target queue to be deallocated. If queue is NULL nothing will be done
+*/
+void ipqDestroy(IntPriorityQueue queue);
+
+/**
+* ipqGetSize: Returns the number of elements in a queue
+* @param queue - The queue which size is requested
+* @return
+* 	-1 if a NULL pointer was sent.
+* 	Otherwise the number of elements in the queue.
+*/
+int ipqGetSize(IntPriorityQueue queue);
+
+/**
+* ipqContains: Checks if an element exists in the queue, using the equal function of the queue.
+*
+* @param queue - The queue to search in
+* @param element - The element to look for
+* @return
+* 	false - if one or more of the inputs is null, or if the element was not found.
+* 	true - if the element was found in the queue.
+*/
+bool ipqContains(IntPriorityQueue queue, PQElement element);
+
+/**
+* ipqInsert: add a copy of element with priority to the queue.
+*
+* @param queue - The queue for which to add the element
+* @param element - The element which need to be added.
+* @param priority - The priority of the element, in the range of the queue.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters
+* 	PQ_ERROR if priority is out of the range of the queue
+* 	PQ_OUT_OF_MEMORY if an allocation failed
+* 	PQ_SUCCESS the element had been inserted successfully
+*/
+PriorityQueueResult ipqInsert(IntPriorityQueue queue, PQElement element, int priority);
+
+/**
+* ipqChangePriority: Changes the priority of the first inserted element that is equal to element
+* and has old_priority. The element is considered as reinserted, so it comes after the elements
+* that already have new_priority.
+*
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters
+* 	PQ_ERROR if new_priority is out of the range of the queue
+* 	PQ_ELEMENT_DOES_NOT_EXISTS if element with old_priority does not exists in the queue
+* 	PQ_SUCCESS the priority had been changed successfully
+*/
+PriorityQueueResult ipqChangePriority(IntPriorityQueue queue, PQElement element, int old_priority,
+                                      int new_priority);
+
+/**
+* ipqRemove: Removes the highest priority element from the queue and frees it.
+*
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent to the function
+* 	PQ_ELEMENT_DOES_NOT_EXISTS if the queue is empty
+* 	PQ_SUCCESS the element had been removed successfully
+*/
+PriorityQueueResult ipqRemove(IntPriorityQueue queue);
+
+/**
+* ipqPop: Removes the highest priority element from the queue and returns it, without freeing it.
+*
+* @param queue - The queue to remove the element from.
+* @param priority - Pointer to assign the priority of the removed element into. May be NULL.
+* @return
+* 	NULL if a NULL was sent as queue or the queue is empty.
+* 	The removed element otherwise. The caller is responsible for freeing it.
+*/
+PQElement ipqPop(IntPriorityQueue queue, int* priority);
+
+/**
+* ipqGetFirst: Returns the highest priority element in the queue without removing it.
+*
+* @param queue - The queue to look in.
+* @param priority - Pointer to assign the priority of the element into. May be NULL.
+* @return
+* 	NULL if a NULL was sent as queue or the queue is empty.
+* 	The highest priority element otherwise. It still belongs to the queue.
+*/
+PQElement ipqGetFirst(IntPriorityQueue queue, int* priority);
+
+/**
+* ipqClear: Removes all elements from the queue, freeing them with the free function.
+*
+* @return
+* 	PQ_NULL_ARGUMENT - if a NULL pointer was sent.
+* 	PQ_SUCCESS - Otherwise.
+*/
+PriorityQueueResult ipqClear(IntPriorityQueue queue);
+
+#endif /* INT_PRIORITY_QUEUE_H */
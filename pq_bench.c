@@ -0,0 +1,368 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "priority_queue.h"
+
+/**
+* Benchmark suite of the priority queue. Every workload runs on every engine for queue sizes from
+* MIN_QUEUE_SIZE to the maximal size (x10 every step), and reports for every operation it measures the
+* time per operation, the allocations made by the copy functions per operation, and the peak RSS of the
+* process so far.
+*
+* Workloads (the priorities of the filled entries):
+*   uniform      - uniformly random priorities.
+*   ascending    - every entry comes after the ones inserted before it.
+*   descending   - every entry comes before the ones inserted before it.
+*   duplicates   - only DUPLICATE_PRIORITIES different priorities.
+*   hold         - the hold model: every round pops the first entry and inserts it back with a later time.
+*   decrease_key - every round raises the priority of a random entry through its handle, and replaces the
+*                  first entry with a new one, like an event loop that reschedules its events.
+* The first four measure insert, change_priority (by element, through the hash index), copy (pqCopy and
+* the first change of the copy, that copies the entries), peek_remove (pqGetFirst and pqRemove until the
+* copy is empty) and remove (pqRemove until the queue is empty).
+*
+* Usage: pq_bench [--csv | --json] [--max-size N]
+* The default output is a table. --csv and --json print one record per measured operation.
+*/
+
+#define MIN_QUEUE_SIZE 10
+#define DEFAULT_MAX_QUEUE_SIZE 1000000
+#define MAX_SORTED_LIST_SIZE 10000
+#define DUPLICATE_PRIORITIES 8
+#define NANOSECONDS_PER_SECOND 1000000000.0
+
+typedef enum Workload_t {
+    WORKLOAD_UNIFORM,
+    WORKLOAD_ASCENDING,
+    WORKLOAD_DESCENDING,
+    WORKLOAD_DUPLICATES,
+    WORKLOAD_HOLD,
+    WORKLOAD_DECREASE_KEY,
+    WORKLOAD_COUNT
+} Workload;
+
+typedef enum OutputFormat_t {
+    OUTPUT_TABLE,
+    OUTPUT_CSV,
+    OUTPUT_JSON
+} OutputFormat;
+
+static const char* workload_names[WORKLOAD_COUNT] = {
+    "uniform", "ascending", "descending", "duplicates", "hold", "decrease_key"
+};
+
+static const PQEngine engines[] = {PQ_ENGINE_SORTED_LIST, PQ_ENGINE_HEAP, PQ_ENGINE_PAIRING};
+static const char* engine_names[] = {"list", "heap", "pairing"};
+#define ENGINE_COUNT ((int)(sizeof(engines) / sizeof(engines[0])))
+
+static OutputFormat output_format = OUTPUT_TABLE;
+static bool is_first_record = true;
+static unsigned long allocation_count = 0;
+static unsigned long random_state = 88172645463325252UL;
+
+static unsigned long nextRandom(void)
+{
+    // xorshift, so the runs are the same on every platform
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+    return random_state;
+}
+
+static int randomBelow(int limit)
+{
+    return (int)(nextRandom() % (unsigned long)limit);
+}
+
+static PQElementPriority copyInt(PQElementPriority n)
+{
+    int* copy = malloc(sizeof(*copy));
+    if (copy != NULL)
+    {
+        allocation_count++;
+        *copy = *(int*)n;
+    }
+    return copy;
+}
+
+static void freeInt(PQElementPriority n)
+{
+    free(n);
+}
+
+static int compareInts(PQElementPriority n1, PQElementPriority n2)
+{
+    int first = *(int*)n1;
+    int second = *(int*)n2;
+    return (first > second) - (first < second);
+}
+
+static bool equalInts(PQElementPriority n1, PQElementPriority n2)
+{
+    return *(int*)n1 == *(int*)n2;
+}
+
+static unsigned int hashInt(PQElement n)
+{
+    return (unsigned int)*(int*)n;
+}
+
+static double getTime(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * NANOSECONDS_PER_SECOND + now.tv_nsec;
+}
+
+static long getPeakRssKilobytes(void)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/** The measurement of one operation: started by startMeasure, and printed by endMeasure */
+typedef struct Measure_t {
+    const char* engine;
+    const char* workload;
+    int size;
+    double start_time;
+    unsigned long start_allocations;
+} Measure;
+
+static void startMeasure(Measure* measure)
+{
+    measure->start_allocations = allocation_count;
+    measure->start_time = getTime();
+}
+
+static void endMeasure(Measure* measure, const char* operation, long operation_count)
+{
+    double nanoseconds = getTime() - measure->start_time;
+    double ns_per_op = operation_count > 0 ? nanoseconds / operation_count : 0;
+    double allocations_per_op = operation_count > 0 ?
+                                (double)(allocation_count - measure->start_allocations) / operation_count : 0;
+    long peak_rss = getPeakRssKilobytes();
+
+    if (output_format == OUTPUT_CSV)
+    {
+        printf("%s,%s,%d,%s,%ld,%.2f,%.3f,%ld\n", measure->engine, measure->workload, measure->size, operation,
+               operation_count, ns_per_op, allocations_per_op, peak_rss);
+    }
+    else if (output_format == OUTPUT_JSON)
+    {
+        printf("%s\n  {\"engine\": \"%s\", \"workload\": \"%s\", \"size\": %d, \"operation\": \"%s\", "
+               "\"ops\": %ld, \"ns_per_op\": %.2f, \"allocs_per_op\": %.3f, \"peak_rss_kb\": %ld}",
+               is_first_record ? "" : ",", measure->engine, measure->workload, measure->size, operation,
+               operation_count, ns_per_op, allocations_per_op, peak_rss);
+    }
+    else
+    {
+        printf("%-8s %-13s %8d %-16s %12.2f %10.3f %12ld\n", measure->engine, measure->workload, measure->size,
+               operation, ns_per_op, allocations_per_op, peak_rss);
+    }
+
+    is_first_record = false;
+    fflush(stdout);
+}
+
+static int getFillPriority(Workload workload, int index, int queue_size)
+{
+    switch (workload)
+    {
+        case WORKLOAD_ASCENDING:
+            return -index;
+        case WORKLOAD_DESCENDING:
+            return index;
+        case WORKLOAD_DUPLICATES:
+            return randomBelow(DUPLICATE_PRIORITIES);
+        default:
+            return randomBelow(queue_size * 4);
+    }
+}
+
+/** Changes the priority of queue_size random entries, copies the queue, and empties the copy and the queue */
+static void runOrderWorkload(PriorityQueue queue, Measure* measure, Workload workload, int* priorities)
+{
+    int queue_size = measure->size;
+
+    startMeasure(measure);
+    for (int i = 0; i < queue_size; i++)
+    {
+        int element = randomBelow(queue_size);
+        int new_priority = getFillPriority(workload, randomBelow(queue_size), queue_size);
+        pqChangePriority(queue, &element, &priorities[element], &new_priority);
+        priorities[element] = new_priority;
+    }
+    endMeasure(measure, "change_priority", queue_size);
+
+    startMeasure(measure);
+    PriorityQueue copy = pqCopy(queue);
+    pqRemove(copy);
+    endMeasure(measure, "copy", 1);
+
+    // the copy is drained the way an event loop does it, reading the first entry before removing it
+    startMeasure(measure);
+    long peek_count = 0;
+    while (pqGetFirst(copy) != NULL)
+    {
+        pqRemove(copy);
+        peek_count++;
+    }
+    endMeasure(measure, "peek_remove", peek_count);
+    pqDestroy(copy);
+
+    startMeasure(measure);
+    while (pqRemove(queue) == PQ_SUCCESS)
+    {
+    }
+    endMeasure(measure, "remove", queue_size);
+}
+
+/** Pops the first entry and inserts it back with a later time, queue_size times */
+static void runHoldWorkload(PriorityQueue queue, Measure* measure)
+{
+    int queue_size = measure->size;
+
+    startMeasure(measure);
+    for (int i = 0; i < queue_size; i++)
+    {
+        int* priority = NULL;
+        int* element = pqPop(queue, (PQElementPriority*)&priority);
+        // the popped entry goes back in without copying, like a simulation event that repeats
+        *priority -= 1 + randomBelow(queue_size);
+        pqInsertTake(queue, element, priority);
+    }
+    endMeasure(measure, "hold", queue_size);
+}
+
+/** Raises the priority of a random entry and replaces the first entry, queue_size times */
+static void runDecreaseKeyWorkload(PriorityQueue queue, Measure* measure, PQHandle* handles)
+{
+    int queue_size = measure->size;
+    int time = queue_size * 4;
+
+    startMeasure(measure);
+    for (int i = 0; i < queue_size; i++)
+    {
+        int index = randomBelow(queue_size);
+        pqUpdatePriorityByHandle(queue, handles[index], &time);
+        time--;
+
+        int* element = pqPop(queue, NULL);
+        int priority = time - randomBelow(queue_size);
+        pqInsertWithHandle(queue, element, &priority, &handles[*element]);
+        free(element);
+    }
+    endMeasure(measure, "decrease_key", queue_size);
+}
+
+static void runWorkload(int engine_index, Workload workload, int queue_size)
+{
+    PQOptions options = {.engine = engines[engine_index], .hash_element = hashInt};
+    PriorityQueue queue = pqCreateWithOptions(copyInt, freeInt, equalInts, copyInt, freeInt, compareInts, &options);
+    int* priorities = malloc(queue_size * sizeof(int));
+    PQHandle* handles = malloc(queue_size * sizeof(PQHandle));
+    if (queue == NULL || priorities == NULL || handles == NULL)
+    {
+        fprintf(stderr, "pq_bench: out of memory at size %d\n", queue_size);
+        pqDestroy(queue);
+        free(priorities);
+        free(handles);
+        return;
+    }
+
+    Measure measure = {.engine = engine_names[engine_index], .workload = workload_names[workload], .size = queue_size};
+
+    startMeasure(&measure);
+    for (int i = 0; i < queue_size; i++)
+    {
+        priorities[i] = getFillPriority(workload, i, queue_size);
+        pqInsertWithHandle(queue, &i, &priorities[i], &handles[i]);
+    }
+    endMeasure(&measure, "insert", queue_size);
+
+    if (workload == WORKLOAD_HOLD)
+    {
+        runHoldWorkload(queue, &measure);
+    }
+    else if (workload == WORKLOAD_DECREASE_KEY)
+    {
+        runDecreaseKeyWorkload(queue, &measure, handles);
+    }
+    else
+    {
+        runOrderWorkload(queue, &measure, workload, priorities);
+    }
+
+    pqDestroy(queue);
+    free(priorities);
+    free(handles);
+}
+
+int main(int argc, char* argv[])
+{
+    int max_queue_size = DEFAULT_MAX_QUEUE_SIZE;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--csv") == 0)
+        {
+            output_format = OUTPUT_CSV;
+        }
+        else if (strcmp(argv[i], "--json") == 0)
+        {
+            output_format = OUTPUT_JSON;
+        }
+        else if (strcmp(argv[i], "--max-size") == 0 && i + 1 < argc)
+        {
+            max_queue_size = atoi(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--csv | --json] [--max-size N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (output_format == OUTPUT_CSV)
+    {
+        printf("engine,workload,size,operation,ops,ns_per_op,allocs_per_op,peak_rss_kb\n");
+    }
+    else if (output_format == OUTPUT_JSON)
+    {
+        printf("[");
+    }
+    else
+    {
+        printf("%-8s %-13s %8s %-16s %12s %10s %12s\n", "engine", "workload", "size", "operation", "ns/op",
+               "allocs/op", "peak RSS kB");
+    }
+
+    for (int queue_size = MIN_QUEUE_SIZE; queue_size <= max_queue_size; queue_size *= 10)
+    {
+        for (int engine_index = 0; engine_index < ENGINE_COUNT; engine_index++)
+        {
+            // the sorted list inserts in O(n), so its large sizes would take hours
+            if (engines[engine_index] == PQ_ENGINE_SORTED_LIST && queue_size > MAX_SORTED_LIST_SIZE)
+            {
+                continue;
+            }
+
+            for (int workload = 0; workload < WORKLOAD_COUNT; workload++)
+            {
+                runWorkload(engine_index, (Workload)workload, queue_size);
+            }
+        }
+    }
+
+    if (output_format == OUTPUT_JSON)
+    {
+        printf("\n]\n");
+    }
+
+    return 0;
+}
@@ -0,0 +1,176 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "priority_queue.h"
+#include "pq_helper.h"
+#include "pq_stats.h"
+#include "pq_hash.h"
+#include "pq_pairing.h"
+
+#define EQUALS_PRIORITY 0
+#define INITIAL_BUCKET_COUNT 16
+#define MAX_LOAD_FACTOR 1
+
+// Spreads the bits of the user hash, so simple hashes (like the value of an int) use all the buckets
+static int bucketIndex(PriorityQueue queue, unsigned int hash_value)
+{
+    hash_value ^= hash_value >> 16;
+    hash_value *= 0x45d9f3bu;
+    hash_value ^= hash_value >> 16;
+    return (int)(hash_value & (unsigned int)(queue->bucket_count - 1));
+}
+
+static void growIndex(PriorityQueue queue)
+{
+    int new_bucket_count = queue->bucket_count * 2;
+    ElementNode* new_buckets = (ElementNode*)calloc(new_bucket_count, sizeof(ElementNode));
+    if (new_buckets == NULL)
+    {
+        return;
+    }
+
+    ElementNode* old_buckets = queue->buckets;
+    int old_bucket_count = queue->bucket_count;
+    queue->buckets = new_buckets;
+    queue->bucket_count = new_bucket_count;
+
+    for (int i = 0; i < old_bucket_count; i++)
+    {
+        ElementNode node = old_buckets[i];
+        while (node != NULL)
+        {
+            ElementNode next_node = node->hash_next;
+            int index = bucketIndex(queue, node->hash_value);
+            node->hash_next = new_buckets[index];
+            new_buckets[index] = node;
+            node = next_node;
+        }
+    }
+
+    free(old_buckets);
+}
+
+PriorityQueueResult hashCreateIndex(PriorityQueue queue)
+{
+    queue->buckets = (ElementNode*)calloc(INITIAL_BUCKET_COUNT, sizeof(ElementNode));
+    if (queue->buckets == NULL)
+    {
+        return PQ_OUT_OF_MEMORY;
+    }
+
+    queue->bucket_count = INITIAL_BUCKET_COUNT;
+    return PQ_SUCCESS;
+}
+
+void hashDestroyIndex(PriorityQueue queue)
+{
+    free(queue->buckets);
+    queue->buckets = NULL;
+    queue->bucket_count = 0;
+}
+
+void hashInsertNode(PriorityQueue queue, ElementNode node)
+{
+    // the node is already counted in the size of the queue
+    if (queue->size > queue->bucket_count * MAX_LOAD_FACTOR)
+    {
+        growIndex(queue);
+    }
+
+    int index = bucketIndex(queue, node->hash_value);
+    node->hash_next = queue->buckets[index];
+    queue->buckets[index] = node;
+}
+
+void hashRemoveNode(PriorityQueue queue, ElementNode node)
+{
+    ElementNode* link = &queue->buckets[bucketIndex(queue, node->hash_value)];
+    while (*link != node)
+    {
+        assert(*link != NULL);
+        link = &(*link)->hash_next;
+    }
+
+    *link = node->hash_next;
+    node->hash_next = NULL;
+}
+
+static bool isHashMatch(PriorityQueue queue, ElementNode node, unsigned int hash_value, PQElement element)
+{
+    PQ_STATS_COUNT(queue, nodes_visited);
+    return node->hash_value == hash_value && EQUAL_ELEMENTS(queue, node->element_data, element);
+}
+
+ElementNode hashFindNode(PriorityQueue queue, PQElement element, PQElementPriority priority)
+{
+    unsigned int hash_value = queue->hash_element(element);
+    ElementNode found_node = NULL;
+
+    // all the equal elements are in the same chain, take the one that comes first
+    for (ElementNode node = queue->buckets[bucketIndex(queue, hash_value)]; node != NULL; node = node->hash_next)
+    {
+        if (isHashMatch(queue, node, hash_value, element) &&
+            (priority == NULL || COMPARE_PRIORITIES(queue, node->element_priority, priority) == EQUALS_PRIORITY) &&
+            (found_node == NULL || compareElementNodes(queue, node, found_node) > 0))
+        {
+            found_node = node;
+        }
+    }
+
+    return found_node;
+}
+
+bool hashContains(PriorityQueue queue, PQElement element)
+{
+    unsigned int hash_value = queue->hash_element(element);
+
+    for (ElementNode node = queue->buckets[bucketIndex(queue, hash_value)]; node != NULL; node = node->hash_next)
+    {
+        if (isHashMatch(queue, node, hash_value, element))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/** Indexes a node, unless it was removed: the removed nodes are not in the index */
+static void indexLinkedNode(PriorityQueue queue, ElementNode node)
+{
+    if (!node->is_removed)
+    {
+        hashInsertNode(queue, node);
+    }
+}
+
+void hashIndexAllNodes(PriorityQueue queue)
+{
+    if (queue->engine == PQ_ENGINE_HEAP)
+    {
+        for (int i = 0; i < queue->heap_size; i++)
+        {
+            indexLinkedNode(queue, queue->heap[i]);
+        }
+        return;
+    }
+
+    if (queue->engine == PQ_ENGINE_PAIRING)
+    {
+        for (ElementNode node = queue->pairing_root; node != NULL; node = pairingNextNode(queue->pairing_root, node))
+        {
+            indexLinkedNode(queue, node);
+        }
+        return;
+    }
+
+    for (ElementNode node = queue->element_list; node != NULL; node = node->next)
+    {
+        indexLinkedNode(queue, node);
+    }
+}
+
+void hashClearIndex(PriorityQueue queue)
+{
+    memset(queue->buckets, 0, queue->bucket_count * sizeof(ElementNode));
+}
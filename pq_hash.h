@@ -0,0 +1,58 @@
+#ifndef PQ_HASH_H
+#define PQ_HASH_H
+
+#include <stdbool.h>
+#include "priority_queue.h"
+#include "pq_helper.h"
+
+/**
+*   hashCreateIndex: Allocates the (empty) hash index of the queue.
+*
+* @return
+* 	PQ_OUT_OF_MEMORY if the allocation failed.
+* 	PQ_SUCCESS otherwise.
+*/
+PriorityQueueResult hashCreateIndex(PriorityQueue queue);
+
+/**
+*   hashDestroyIndex: Frees the hash index of the queue. The nodes are not freed.
+*/
+void hashDestroyIndex(PriorityQueue queue);
+
+/**
+*   hashInsertNode: Adds a node to the hash index of the queue, by the hash_value of the node.
+*   If the index can not grow, the node is still added and the chains get longer.
+*/
+void hashInsertNode(PriorityQueue queue, ElementNode node);
+
+/**
+*   hashRemoveNode: Removes a node from the hash index of the queue.
+*/
+void hashRemoveNode(PriorityQueue queue, ElementNode node);
+
+/**
+*   hashFindNode: Finds the first node (by the queue order) that its element is equal to element,
+*   and if priority is not NULL, that its priority is equal to priority.
+*
+* @return
+* 	NULL if there is no such node.
+* 	The found node otherwise.
+*/
+ElementNode hashFindNode(PriorityQueue queue, PQElement element, PQElementPriority priority);
+
+/**
+*   hashContains: Checks if there is a node that its element is equal to element.
+*/
+bool hashContains(PriorityQueue queue, PQElement element);
+
+/**
+*   hashIndexAllNodes: Adds all the nodes in the storage of the queue to its (empty) hash index.
+*/
+void hashIndexAllNodes(PriorityQueue queue);
+
+/**
+*   hashClearIndex: Removes all the nodes from the hash index of the queue.
+*/
+void hashClearIndex(PriorityQueue queue);
+
+#endif /* PQ_HASH_H */
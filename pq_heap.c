@@ -0,0 +1,395 @@
+#include <stdlib.h>
+#include <assert.h>
+#include "priority_queue.h"
+#include "pq_helper.h"
+#include "pq_stats.h"
+#include "pq_heap.h"
+
+#define INITIAL_HEAP_CAPACITY 16
+#define HEAP_ROOT 0
+#define LAST_HEAP_ARITY 2
+
+static void setHeapNode(PriorityQueue queue, int index, ElementNode node)
+{
+    queue->heap[index] = node;
+    node->heap_index = index;
+}
+
+static int parentIndex(PriorityQueue queue, int index)
+{
+    return (index - 1) / queue->heap_arity;
+}
+
+/**
+* A queue that evicts keeps a second heap of the same nodes, a binary one whose root is the node that
+* comes last, so the node to evict is found in O(1) and every change of the heap costs O(log n) there too.
+*/
+static bool keepsLastHeap(PriorityQueue queue)
+{
+    return queue->capacity > 0 && queue->overflow_policy == PQ_OVERFLOW_EVICT;
+}
+
+static void setLastHeapNode(PriorityQueue queue, int index, ElementNode node)
+{
+    queue->last_heap[index] = node;
+    node->last_heap_index = index;
+}
+
+static void lastSiftUp(PriorityQueue queue, int index)
+{
+    ElementNode node = queue->last_heap[index];
+
+    // move the parents that come before node down until the place of node is found
+    while (index > HEAP_ROOT)
+    {
+        PQ_STATS_COUNT(queue, nodes_visited);
+        int parent = (index - 1) / LAST_HEAP_ARITY;
+        if (compareElementNodes(queue, node, queue->last_heap[parent]) > 0)
+        {
+            break;
+        }
+
+        setLastHeapNode(queue, index, queue->last_heap[parent]);
+        index = parent;
+    }
+
+    setLastHeapNode(queue, index, node);
+}
+
+static void lastSiftDown(PriorityQueue queue, int index)
+{
+    ElementNode node = queue->last_heap[index];
+
+    while (true)
+    {
+        int first_child = index * LAST_HEAP_ARITY + 1;
+        if (first_child >= queue->heap_size)
+        {
+            break;
+        }
+
+        // find the child that comes last
+        PQ_STATS_COUNT(queue, nodes_visited);
+        int last_child = first_child;
+        if (first_child + 1 < queue->heap_size &&
+            compareElementNodes(queue, queue->last_heap[first_child + 1], queue->last_heap[first_child]) < 0)
+        {
+            last_child = first_child + 1;
+        }
+
+        if (compareElementNodes(queue, node, queue->last_heap[last_child]) < 0)
+        {
+            break;
+        }
+
+        setLastHeapNode(queue, index, queue->last_heap[last_child]);
+        index = last_child;
+    }
+
+    setLastHeapNode(queue, index, node);
+}
+
+static void lastFixNodeAt(PriorityQueue queue, int index)
+{
+    if (index > HEAP_ROOT && compareElementNodes(queue, queue->last_heap[index],
+                                                 queue->last_heap[(index - 1) / LAST_HEAP_ARITY]) < 0)
+    {
+        lastSiftUp(queue, index);
+    }
+    else
+    {
+        lastSiftDown(queue, index);
+    }
+}
+
+static void siftUp(PriorityQueue queue, int index)
+{
+    ElementNode node = queue->heap[index];
+
+    // move the parents down until the place of node is found
+    while (index > HEAP_ROOT)
+    {
+        PQ_STATS_COUNT(queue, nodes_visited);
+        int parent = parentIndex(queue, index);
+        if (compareElementNodes(queue, queue->heap[parent], node) > 0)
+        {
+            break;
+        }
+
+        setHeapNode(queue, index, queue->heap[parent]);
+        index = parent;
+    }
+
+    setHeapNode(queue, index, node);
+}
+
+static void siftDown(PriorityQueue queue, int index)
+{
+    ElementNode node = queue->heap[index];
+
+    while (true)
+    {
+        int first_child = index * queue->heap_arity + 1;
+        if (first_child >= queue->heap_size)
+        {
+            break;
+        }
+
+        // find the child that comes first
+        PQ_STATS_COUNT(queue, nodes_visited);
+        int last_child = first_child + queue->heap_arity;
+        if (last_child > queue->heap_size)
+        {
+            last_child = queue->heap_size;
+        }
+
+        int best_child = first_child;
+        for (int child = first_child + 1; child < last_child; child++)
+        {
+            if (compareElementNodes(queue, queue->heap[child], queue->heap[best_child]) > 0)
+            {
+                best_child = child;
+            }
+        }
+
+        if (compareElementNodes(queue, node, queue->heap[best_child]) > 0)
+        {
+            break;
+        }
+
+        setHeapNode(queue, index, queue->heap[best_child]);
+        index = best_child;
+    }
+
+    setHeapNode(queue, index, node);
+}
+
+PriorityQueueResult heapReserve(PriorityQueue queue, int capacity)
+{
+    if (capacity <= queue->heap_capacity)
+    {
+        return PQ_SUCCESS;
+    }
+
+    int new_capacity = queue->heap_capacity == 0 ? INITIAL_HEAP_CAPACITY : queue->heap_capacity;
+    while (new_capacity < capacity)
+    {
+        new_capacity *= 2;
+    }
+
+    // the capacity counts only once both arrays grew, and a bigger last heap is harmless
+    if (keepsLastHeap(queue))
+    {
+        ElementNode* new_last_heap = (ElementNode*)realloc(queue->last_heap, new_capacity * sizeof(ElementNode));
+        if (new_last_heap == NULL)
+        {
+            return PQ_OUT_OF_MEMORY;
+        }
+        queue->last_heap = new_last_heap;
+    }
+
+    ElementNode* new_heap = (ElementNode*)realloc(queue->heap, new_capacity * sizeof(ElementNode));
+    if (new_heap == NULL)
+    {
+        return PQ_OUT_OF_MEMORY;
+    }
+
+    queue->heap = new_heap;
+    queue->heap_capacity = new_capacity;
+
+    return PQ_SUCCESS;
+}
+
+void heapShrink(PriorityQueue queue)
+{
+    if (queue->heap_size == 0)
+    {
+        heapDestroy(queue);
+        return;
+    }
+
+    if (keepsLastHeap(queue))
+    {
+        ElementNode* new_last_heap = (ElementNode*)realloc(queue->last_heap, queue->heap_size * sizeof(ElementNode));
+        if (new_last_heap == NULL)
+        {
+            return;
+        }
+        queue->last_heap = new_last_heap;
+    }
+
+    ElementNode* new_heap = (ElementNode*)realloc(queue->heap, queue->heap_size * sizeof(ElementNode));
+    if (new_heap == NULL)
+    {
+        // the old array is still valid, just bigger than needed
+        return;
+    }
+
+    queue->heap = new_heap;
+    queue->heap_capacity = queue->heap_size;
+}
+
+void heapDestroy(PriorityQueue queue)
+{
+    free(queue->heap);
+    free(queue->last_heap);
+    queue->heap = NULL;
+    queue->last_heap = NULL;
+    queue->heap_capacity = 0;
+}
+
+void heapInsertNode(PriorityQueue queue, ElementNode node)
+{
+    assert(queue->heap_size < queue->heap_capacity);
+
+    setHeapNode(queue, queue->heap_size, node);
+    queue->heap_size++;
+    siftUp(queue, node->heap_index);
+
+    if (keepsLastHeap(queue))
+    {
+        setLastHeapNode(queue, queue->heap_size - 1, node);
+        lastSiftUp(queue, queue->heap_size - 1);
+    }
+}
+
+void heapAppendNodes(PriorityQueue queue, ElementNode list)
+{
+    for (ElementNode node = list; node != NULL; node = node->next)
+    {
+        assert(queue->heap_size < queue->heap_capacity);
+        setHeapNode(queue, queue->heap_size, node);
+        if (keepsLastHeap(queue))
+        {
+            setLastHeapNode(queue, queue->heap_size, node);
+        }
+        queue->heap_size++;
+    }
+
+    // sift down every parent, from the last one up to the root
+    if (queue->heap_size > 1)
+    {
+        for (int index = parentIndex(queue, queue->heap_size - 1); index >= HEAP_ROOT; index--)
+        {
+            siftDown(queue, index);
+        }
+
+        if (keepsLastHeap(queue))
+        {
+            for (int index = (queue->heap_size - 2) / LAST_HEAP_ARITY; index >= HEAP_ROOT; index--)
+            {
+                lastSiftDown(queue, index);
+            }
+        }
+    }
+}
+
+static void fixNodeAt(PriorityQueue queue, int index)
+{
+    if (index > HEAP_ROOT && compareElementNodes(queue, queue->heap[index],
+                                                 queue->heap[parentIndex(queue, index)]) > 0)
+    {
+        siftUp(queue, index);
+    }
+    else
+    {
+        siftDown(queue, index);
+    }
+}
+
+void heapFixNodeAt(PriorityQueue queue, int index)
+{
+    assert(index >= HEAP_ROOT && index < queue->heap_size);
+
+    fixNodeAt(queue, index);
+    if (keepsLastHeap(queue))
+    {
+        lastFixNodeAt(queue, queue->heap[index]->last_heap_index);
+    }
+}
+
+ElementNode heapRemoveNodeAt(PriorityQueue queue, int index)
+{
+    assert(index >= HEAP_ROOT && index < queue->heap_size);
+
+    ElementNode removed_node = queue->heap[index];
+    queue->heap_size--;
+
+    // fill the hole with the last node and fix its place
+    if (index != queue->heap_size)
+    {
+        setHeapNode(queue, index, queue->heap[queue->heap_size]);
+        fixNodeAt(queue, index);
+    }
+    queue->heap[queue->heap_size] = NULL;
+
+    if (keepsLastHeap(queue))
+    {
+        int last_index = removed_node->last_heap_index;
+        if (last_index != queue->heap_size)
+        {
+            setLastHeapNode(queue, last_index, queue->last_heap[queue->heap_size]);
+            lastFixNodeAt(queue, last_index);
+        }
+        queue->last_heap[queue->heap_size] = NULL;
+    }
+
+    return removed_node;
+}
+
+ElementNode heapGetLastNode(PriorityQueue queue)
+{
+    assert(keepsLastHeap(queue));
+    return queue->heap_size == 0 ? NULL : queue->last_heap[HEAP_ROOT];
+}
+
+ElementNode heapBuildElementList(PriorityQueue queue)
+{
+    if (queue->heap_size == 0)
+    {
+        return NULL;
+    }
+
+    for (int i = 0; i < queue->heap_size - 1; i++)
+    {
+        queue->heap[i]->next = queue->heap[i + 1];
+    }
+    queue->heap[queue->heap_size - 1]->next = NULL;
+
+    return sortElementList(queue, queue->heap[HEAP_ROOT]);
+}
+
+PriorityQueueResult copyElementHeap(PriorityQueue queue, PriorityQueue new_queue)
+{
+    if (heapReserve(new_queue, queue->heap_size) != PQ_SUCCESS)
+    {
+        return PQ_OUT_OF_MEMORY;
+    }
+
+    for (int i = 0; i < queue->heap_size; i++)
+    {
+        ElementNode node = queue->heap[i];
+        ElementNode new_node = createNewElementNode(new_queue, node->element_data, node->element_priority);
+        if (new_node == NULL)
+        {
+            // free what was copied so far
+            while (new_queue->heap_size > 0)
+            {
+                new_queue->heap_size--;
+                freeElementNode(new_queue, new_queue->heap[new_queue->heap_size]);
+            }
+            return PQ_OUT_OF_MEMORY;
+        }
+
+        new_node->sequence = node->sequence;
+        new_node->is_removed = node->is_removed;
+        setHeapNode(new_queue, i, new_node);
+        if (keepsLastHeap(new_queue))
+        {
+            setLastHeapNode(new_queue, node->last_heap_index, new_node);
+        }
+        new_queue->heap_size++;
+    }
+
+    return PQ_SUCCESS;
+}
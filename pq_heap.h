@@ -0,0 +1,90 @@
+#ifndef PQ_HEAP_H
+#define PQ_HEAP_H
+
+#include "priority_queue.h"
+#include "pq_helper.h"
+
+/**
+*   heapReserve: Makes sure the heap array of the queue can hold at least capacity nodes.
+*
+* @return
+* 	PQ_OUT_OF_MEMORY if the array could not grow.
+* 	PQ_SUCCESS otherwise.
+*/
+PriorityQueueResult heapReserve(PriorityQueue queue, int capacity);
+
+/**
+*   heapShrink: Shrinks the heap array of the queue to the number of nodes in the heap.
+*/
+void heapShrink(PriorityQueue queue);
+
+/**
+*   heapDestroy: Frees the heap arrays of the queue, without freeing the nodes in them.
+*/
+void heapDestroy(PriorityQueue queue);
+
+/**
+*   heapInsertNode: Inserts a node into the heap. The heap must have room for it (see heapReserve).
+*
+* @param queue - The priority queue of the heap.
+* @param node - The node to insert.
+*/
+void heapInsertNode(PriorityQueue queue, ElementNode node);
+
+/**
+*   heapAppendNodes: Appends the nodes of a list (linked by next) to the heap array and rebuilds
+*   the heap order of the whole array at once, in O(n) time. The heap must have room for them.
+*
+* @param queue - The priority queue of the heap.
+* @param list - The first node of the list to append.
+*/
+void heapAppendNodes(PriorityQueue queue, ElementNode list);
+
+/**
+*   heapFixNodeAt: Moves the node at the given index of the heap array up or down to its place,
+*   after its order was changed.
+*
+* @param queue - The priority queue of the heap.
+* @param index - The index of the node in the heap array.
+*/
+void heapFixNodeAt(PriorityQueue queue, int index);
+
+/**
+*   heapRemoveNodeAt: Removes the node at the given index of the heap array, without freeing it.
+*
+* @param queue - The priority queue of the heap.
+* @param index - The index of the node in the heap array.
+* @return
+* 	The removed node.
+*/
+ElementNode heapRemoveNodeAt(PriorityQueue queue, int index);
+
+/**
+*   heapGetLastNode: Returns the node that comes last in the heap, in O(1).
+*   Only a queue that evicts keeps it (see PQOptions.overflow_policy).
+*
+* @return
+* 	NULL if the heap is empty.
+* 	The last node otherwise.
+*/
+ElementNode heapGetLastNode(PriorityQueue queue);
+
+/**
+*   heapBuildElementList: Links all the nodes of the heap by next, in the queue order.
+*
+* @return
+* 	The first node of the built list, or NULL if the heap is empty.
+*/
+ElementNode heapBuildElementList(PriorityQueue queue);
+
+/**
+*   copyElementHeap: Copies the nodes of the heap of queue into the (empty) heap of new_queue.
+*   The copied nodes keep their places, so the copy is a valid heap without reordering.
+*
+* @return
+* 	PQ_OUT_OF_MEMORY if an allocation failed. new_queue is left empty in that case.
+* 	PQ_SUCCESS otherwise.
+*/
+PriorityQueueResult copyElementHeap(PriorityQueue queue, PriorityQueue new_queue);
+
+#endif /* PQ_HEAP_H */
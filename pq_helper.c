@@ -1,11 +1,75 @@
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include "priority_queue.h"
 #include "pq_helper.h"
+#include "pq_stats.h"
+#include "pq_heap.h"
+#include "pq_hash.h"
+#include "pq_pool.h"
+#include "pq_pairing.h"
 
 #define NULL_INPUT_ERROR -1
 #define EQUALS_PRIORITY 0
 
+// The insertion order of all the element nodes, used as the tie-breaker between equal priorities.
+// Taken atomically, since the shards of a concurrent queue insert from several threads at once.
+static unsigned long next_sequence = 0;
+
+static unsigned long takeNextSequence(void)
+{
+    return __atomic_fetch_add(&next_sequence, 1, __ATOMIC_RELAXED);
+}
+
+// The inline data of a node is kept after it, aligned like the widest types a priority is made of.
+typedef union inline_alignment_t
+{
+    long long integer;
+    double floating;
+    void* pointer;
+} InlineAlignment;
+
+static int alignInlineSize(int size)
+{
+    return (int)((size + sizeof(InlineAlignment) - 1) / sizeof(InlineAlignment) * sizeof(InlineAlignment));
+}
+
+static void* getInlineElement(PriorityQueue queue, ElementNode node)
+{
+    return (char*)node + alignInlineSize(sizeof(struct element_t));
+}
+
+static void* getInlinePriority(PriorityQueue queue, ElementNode node)
+{
+    return (char*)getInlineElement(queue, node) + alignInlineSize(queue->element_size);
+}
+
+void setInlineSizes(PriorityQueue queue, int element_size, int priority_size)
+{
+    queue->element_size = element_size;
+    queue->priority_size = priority_size;
+    queue->node_size = sizeof(struct element_t);
+    if (element_size > 0 || priority_size > 0)
+    {
+        queue->node_size = alignInlineSize(sizeof(struct element_t)) + alignInlineSize(element_size) +
+                           alignInlineSize(priority_size);
+    }
+}
+
+static void initElementNode(PriorityQueue queue, ElementNode node, PQElement element, PQElementPriority priority)
+{
+    node->element_data = element;
+    node->element_priority = priority;
+    node->next = NULL;
+    node->prev = NULL;
+    node->sequence = takeNextSequence();
+    node->heap_index = 0;
+    node->last_heap_index = 0;
+    node->hash_value = queue->hash_element != NULL ? queue->hash_element(element) : 0;
+    node->hash_next = NULL;
+    node->is_removed = false;
+}
+
 ElementNode createNewElementNode(PriorityQueue queue, PQElement element, PQElementPriority priority)
 {
     if (queue == NULL || element == NULL || priority == NULL)
@@ -13,62 +77,956 @@ ElementNode createNewElementNode(PriorityQueue queue, PQElement element, PQEleme
         return NULL;
     }
 
-    ElementNode new_element = (ElementNode)malloc(sizeof(struct element_t));
+    ElementNode new_element = poolAllocateNode(queue);
     if(new_element == NULL)
     {
         return NULL;
     }
 
-    new_element->element_data = queue->copy_element(element);
-    new_element->element_priority = queue->copy_priority(priority);
-    new_element->next = NULL;
+    PQElement new_data = queue->element_size > 0 ?
+                         memcpy(getInlineElement(queue, new_element), element, queue->element_size) :
+                         COPY_ELEMENT(queue, element);
+    if (new_data == NULL)
+    {
+        poolFreeNode(queue, new_element);
+        return NULL;
+    }
+
+    PQElementPriority new_priority = queue->priority_size > 0 ?
+                                     memcpy(getInlinePriority(queue, new_element), priority, queue->priority_size) :
+                                     COPY_PRIORITY(queue, priority);
+    if (new_priority == NULL)
+    {
+        if (queue->element_size == 0)
+        {
+            FREE_ELEMENT(queue, new_data);
+        }
+        poolFreeNode(queue, new_element);
+        return NULL;
+    }
+
+    initElementNode(queue, new_element, new_data, new_priority);
+    return new_element;
+}
+
+ElementNode adoptNewElementNode(PriorityQueue queue, PQElement element, PQElementPriority priority)
+{
+    if (queue == NULL || element == NULL || priority == NULL)
+    {
+        return NULL;
+    }
+
+    ElementNode new_element = poolAllocateNode(queue);
+    if(new_element == NULL)
+    {
+        return NULL;
+    }
+
+    if (queue->element_size > 0)
+    {
+        element = memcpy(getInlineElement(queue, new_element), element, queue->element_size);
+    }
+    if (queue->priority_size > 0)
+    {
+        priority = memcpy(getInlinePriority(queue, new_element), priority, queue->priority_size);
+    }
 
+    initElementNode(queue, new_element, element, priority);
     return new_element;
 }
 
 void freeElementNode(PriorityQueue queue, ElementNode element)
-{  
-    queue->free_element(element->element_data);
-    queue->free_priority(element->element_priority);
-    free(element);
+{
+    if (queue->element_size == 0)
+    {
+        FREE_ELEMENT(queue, element->element_data);
+    }
+    if (queue->priority_size == 0)
+    {
+        FREE_PRIORITY(queue, element->element_priority);
+    }
+    poolFreeNode(queue, element);
 }
 
-PriorityQueueResult removeElementNode(PriorityQueue queue, ElementNode element_before)
+void releaseAdoptedData(PriorityQueue queue, PQElement element, PQElementPriority priority)
 {
-    if (queue == NULL || element_before == NULL)
+    if (queue->element_size > 0)
+    {
+        FREE_ELEMENT(queue, element);
+    }
+    if (queue->priority_size > 0)
     {
-        return PQ_NULL_ARGUMENT;
+        FREE_PRIORITY(queue, priority);
     }
+}
 
-    ElementNode element_to_remove = element_before->next;
-    ElementNode next_element = element_to_remove->next;
+PriorityQueueResult takeElementNodeData(PriorityQueue queue, ElementNode node, PQElement* element,
+                                        PQElementPriority* priority)
+{
+    PQElement taken_element = node->element_data;
+    if (queue->element_size > 0)
+    {
+        taken_element = COPY_ELEMENT(queue, node->element_data);
+        if (taken_element == NULL)
+        {
+            return PQ_OUT_OF_MEMORY;
+        }
+    }
 
-    freeElementNode(queue, element_to_remove);
-    element_before->next = next_element;
+    PQElementPriority taken_priority = node->element_priority;
+    if (queue->priority_size > 0)
+    {
+        taken_priority = COPY_PRIORITY(queue, node->element_priority);
+        if (taken_priority == NULL)
+        {
+            if (queue->element_size > 0)
+            {
+                FREE_ELEMENT(queue, taken_element);
+            }
+            return PQ_OUT_OF_MEMORY;
+        }
+    }
 
+    *element = taken_element;
+    *priority = taken_priority;
     return PQ_SUCCESS;
 }
 
-ElementNode copyElementList(PriorityQueue queue)
+ElementNode copyElementList(PriorityQueue queue, PriorityQueue new_queue)
 {
-    if (queue == NULL || queue->element_list == NULL)
+    if (queue == NULL || new_queue == NULL || queue->element_list == NULL)
     {
         return NULL;
     }
 
-    ElementNode current_element = queue->element_list;
-    ElementNode new_element_list = createNewElementNode(queue,current_element->element_data, 
-                                                        current_element->element_priority);;
-    ElementNode new_current_element = new_element_list;
+    struct element_t new_list_head;
+    new_list_head.next = NULL;
+    ElementNode new_current_element = &new_list_head;
 
-    current_element = current_element->next;
+    for (ElementNode current_element = queue->element_list; current_element != NULL;
+         current_element = current_element->next)
+    {
+        new_current_element->next = createNewElementNode(new_queue, current_element->element_data,
+                                                         current_element->element_priority);
+        if (new_current_element->next == NULL)
+        {
+            // free what was copied so far
+            while (new_list_head.next != NULL)
+            {
+                ElementNode next_element = new_list_head.next->next;
+                freeElementNode(new_queue, new_list_head.next);
+                new_list_head.next = next_element;
+            }
+            return NULL;
+        }
 
-    while(current_element != NULL){
-        new_current_element->next = createNewElementNode(queue,current_element->element_data, 
-                                                         current_element->element_priority);    
-        current_element = current_element->next;
+        new_current_element->next->prev = new_current_element == &new_list_head ? NULL : new_current_element;
         new_current_element = new_current_element->next;
+        new_current_element->sequence = current_element->sequence;
+        new_current_element->is_removed = current_element->is_removed;
+    }
+
+    return new_list_head.next;
+}
+
+int compareElementNodes(PriorityQueue queue, ElementNode first, ElementNode second)
+{
+    int priority_compare = COMPARE_PRIORITIES(queue, first->element_priority, second->element_priority);
+    if (priority_compare != EQUALS_PRIORITY)
+    {
+        return priority_compare;
     }
 
-    return new_element_list;
-}
\ No newline at end of file
+    // equal priorities - the first inserted comes first
+    return first->sequence < second->sequence ? 1 : -1;
+}
+
+static ElementNode mergeElementLists(PriorityQueue queue, ElementNode first, ElementNode second)
+{
+    struct element_t merged_head;
+    ElementNode merged_tail = &merged_head;
+
+    while (first != NULL && second != NULL)
+    {
+        if (compareElementNodes(queue, first, second) > 0)
+        {
+            merged_tail->next = first;
+            first = first->next;
+        }
+        else
+        {
+            merged_tail->next = second;
+            second = second->next;
+        }
+        merged_tail = merged_tail->next;
+    }
+
+    merged_tail->next = first != NULL ? first : second;
+    return merged_head.next;
+}
+
+ElementNode sortElementList(PriorityQueue queue, ElementNode list)
+{
+    if (list == NULL || list->next == NULL)
+    {
+        return list;
+    }
+
+    // split the list in the middle
+    ElementNode middle = list;
+    for (ElementNode fast = list->next; fast != NULL && fast->next != NULL; fast = fast->next->next)
+    {
+        middle = middle->next;
+    }
+    ElementNode second_half = middle->next;
+    middle->next = NULL;
+
+    return mergeElementLists(queue, sortElementList(queue, list), sortElementList(queue, second_half));
+}
+
+static bool isElementListSorted(PriorityQueue queue, ElementNode list)
+{
+    for (ElementNode node = list; node != NULL && node->next != NULL; node = node->next)
+    {
+        if (compareElementNodes(queue, node, node->next) < 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void linkListNode(PriorityQueue queue, ElementNode node)
+{
+    // check if need to be in the first place - the highest priority
+    if (queue->element_list == NULL || compareElementNodes(queue, node, queue->element_list) > 0)
+    {
+        node->prev = NULL;
+        node->next = queue->element_list;
+    }
+    else
+    {
+        // put the element in the right place in list
+        ElementNode current_element = queue->element_list;
+        while (current_element->next != NULL && compareElementNodes(queue, current_element->next, node) > 0)
+        {
+            PQ_STATS_COUNT(queue, nodes_visited);
+            current_element = current_element->next;
+        }
+
+        node->prev = current_element;
+        node->next = current_element->next;
+    }
+
+    if (node->prev == NULL)
+    {
+        queue->element_list = node;
+    }
+    else
+    {
+        node->prev->next = node;
+    }
+
+    if (node->next == NULL)
+    {
+        queue->last_element = node;
+    }
+    else
+    {
+        node->next->prev = node;
+    }
+}
+
+static void unlinkListNode(PriorityQueue queue, ElementNode node)
+{
+    if (node->prev == NULL)
+    {
+        queue->element_list = node->next;
+    }
+    else
+    {
+        node->prev->next = node->next;
+    }
+
+    if (node->next == NULL)
+    {
+        queue->last_element = node->prev;
+    }
+    else
+    {
+        node->next->prev = node->prev;
+    }
+
+    node->next = NULL;
+    node->prev = NULL;
+}
+
+PriorityQueueResult linkElementNode(PriorityQueue queue, ElementNode node)
+{
+    queue->version++;
+
+    if (queue->engine == PQ_ENGINE_HEAP)
+    {
+        if (heapReserve(queue, queue->heap_size + 1) != PQ_SUCCESS)
+        {
+            return PQ_OUT_OF_MEMORY;
+        }
+
+        heapInsertNode(queue, node);
+        queue->is_element_list_valid = false;
+    }
+    else if (queue->engine == PQ_ENGINE_PAIRING)
+    {
+        pairingInsertNode(queue, node);
+        queue->is_element_list_valid = false;
+    }
+    else
+    {
+        linkListNode(queue, node);
+    }
+
+    queue->size++;
+    PQ_STATS_UPDATE_MAX_SIZE(queue);
+
+    if (queue->buckets != NULL)
+    {
+        hashInsertNode(queue, node);
+    }
+
+    return PQ_SUCCESS;
+}
+
+PriorityQueueResult linkElementNodes(PriorityQueue queue, ElementNode list, int count)
+{
+    queue->version++;
+
+    if (queue->engine == PQ_ENGINE_HEAP && heapReserve(queue, queue->heap_size + count) != PQ_SUCCESS)
+    {
+        return PQ_OUT_OF_MEMORY;
+    }
+
+    // index the nodes before the list is relinked
+    queue->size += count;
+    PQ_STATS_UPDATE_MAX_SIZE(queue);
+    if (queue->buckets != NULL)
+    {
+        for (ElementNode node = list; node != NULL; node = node->next)
+        {
+            hashInsertNode(queue, node);
+        }
+    }
+
+    if (queue->engine == PQ_ENGINE_HEAP)
+    {
+        // rebuilding is O(n + k), inserting one by one is O(k log n)
+        if (count * 2 >= queue->heap_size)
+        {
+            heapAppendNodes(queue, list);
+        }
+        else
+        {
+            for (ElementNode node = list; node != NULL; node = node->next)
+            {
+                heapInsertNode(queue, node);
+            }
+        }
+        queue->is_element_list_valid = false;
+        return PQ_SUCCESS;
+    }
+
+    if (queue->engine == PQ_ENGINE_PAIRING)
+    {
+        // inserting is O(1), so there is nothing to save by linking the nodes together
+        ElementNode node = list;
+        while (node != NULL)
+        {
+            ElementNode next_node = node->next;
+            pairingInsertNode(queue, node);
+            node = next_node;
+        }
+        queue->is_element_list_valid = false;
+        return PQ_SUCCESS;
+    }
+
+    // a list that is already in order (like the list of another queue) only needs the merge
+    if (!isElementListSorted(queue, list))
+    {
+        list = sortElementList(queue, list);
+    }
+    queue->element_list = mergeElementLists(queue, queue->element_list, list);
+
+    // the merge links only by next, so fix the prev links
+    ElementNode prev_node = NULL;
+    for (ElementNode node = queue->element_list; node != NULL; node = node->next)
+    {
+        node->prev = prev_node;
+        prev_node = node;
+    }
+    queue->last_element = prev_node;
+
+    return PQ_SUCCESS;
+}
+
+void meldElementTree(PriorityQueue queue, ElementNode root, int count)
+{
+    queue->version++;
+    queue->size += count;
+    PQ_STATS_UPDATE_MAX_SIZE(queue);
+
+    if (queue->buckets != NULL)
+    {
+        for (ElementNode node = root; node != NULL; node = pairingNextNode(root, node))
+        {
+            node->hash_value = queue->hash_element(node->element_data);
+            hashInsertNode(queue, node);
+        }
+    }
+
+    pairingMeldTree(queue, root);
+    queue->is_element_list_valid = false;
+}
+
+void unlinkElementNode(PriorityQueue queue, ElementNode node)
+{
+    queue->version++;
+
+    if (queue->engine == PQ_ENGINE_HEAP)
+    {
+        heapRemoveNodeAt(queue, node->heap_index);
+        queue->is_element_list_valid = false;
+    }
+    else if (queue->engine == PQ_ENGINE_PAIRING)
+    {
+        pairingRemoveNode(queue, node);
+        queue->is_element_list_valid = false;
+    }
+    else
+    {
+        unlinkListNode(queue, node);
+    }
+
+    queue->size--;
+
+    // a removed node left the hash index when it was marked
+    if (node->is_removed)
+    {
+        queue->removed_count--;
+    }
+    else if (queue->buckets != NULL)
+    {
+        hashRemoveNode(queue, node);
+    }
+}
+
+void markElementNodeRemoved(PriorityQueue queue, ElementNode node)
+{
+    node->is_removed = true;
+    queue->removed_count++;
+    queue->version++;
+    if (queue->buckets != NULL)
+    {
+        hashRemoveNode(queue, node);
+    }
+
+    if (queue->removed_count * 100 > queue->max_removed_percent * queue->size)
+    {
+        compactElementNodes(queue);
+    }
+    else
+    {
+        freeFirstRemovedNodes(queue);
+    }
+}
+
+void freeFirstRemovedNodes(PriorityQueue queue)
+{
+    ElementNode first_node = getFirstElementNode(queue);
+    while (first_node != NULL && first_node->is_removed)
+    {
+        unlinkElementNode(queue, first_node);
+        freeElementNode(queue, first_node);
+        first_node = getFirstElementNode(queue);
+    }
+}
+
+void compactElementNodes(PriorityQueue queue)
+{
+    if (queue->removed_count == 0)
+    {
+        return;
+    }
+
+    // unlinking does not change the next links of the element list of the heap engines,
+    // and the list engine only changes the links of the neighbours
+    ElementNode node = getElementList(queue);
+    while (node != NULL)
+    {
+        ElementNode next_node = node->next;
+        if (node->is_removed)
+        {
+            unlinkElementNode(queue, node);
+            freeElementNode(queue, node);
+        }
+        node = next_node;
+    }
+
+    assert(queue->removed_count == 0 && isSizeConsistent(queue));
+}
+
+ElementNode skipRemovedNodes(ElementNode node)
+{
+    while (node != NULL && node->is_removed)
+    {
+        node = node->next;
+    }
+
+    return node;
+}
+
+void relinkElementNode(PriorityQueue queue, ElementNode node, bool is_moved_up)
+{
+    node->sequence = takeNextSequence();
+    queue->version++;
+
+    if (queue->engine == PQ_ENGINE_HEAP)
+    {
+        heapFixNodeAt(queue, node->heap_index);
+        queue->is_element_list_valid = false;
+        return;
+    }
+
+    if (queue->engine == PQ_ENGINE_PAIRING)
+    {
+        pairingFixNode(queue, node, is_moved_up);
+        queue->is_element_list_valid = false;
+        return;
+    }
+
+    // the list is not changed if the node is still between its neighbours
+    if ((node->prev == NULL || compareElementNodes(queue, node->prev, node) > 0) &&
+        (node->next == NULL || compareElementNodes(queue, node, node->next) > 0))
+    {
+        return;
+    }
+
+    unlinkListNode(queue, node);
+    linkListNode(queue, node);
+}
+
+PriorityQueueResult replaceElementNodePriority(PriorityQueue queue, ElementNode node, PQElementPriority priority)
+{
+    bool is_moved_up = COMPARE_PRIORITIES(queue, priority, node->element_priority) > EQUALS_PRIORITY;
+    if (queue->priority_size > 0)
+    {
+        memmove(node->element_priority, priority, queue->priority_size);
+        relinkElementNode(queue, node, is_moved_up);
+        freeFirstRemovedNodes(queue);
+        return PQ_SUCCESS;
+    }
+
+    PQElementPriority new_priority = COPY_PRIORITY(queue, priority);
+    if (new_priority == NULL)
+    {
+        return PQ_OUT_OF_MEMORY;
+    }
+
+    FREE_PRIORITY(queue, node->element_priority);
+    node->element_priority = new_priority;
+    relinkElementNode(queue, node, is_moved_up);
+    freeFirstRemovedNodes(queue);
+
+    return PQ_SUCCESS;
+}
+
+PriorityQueueResult replaceElementNodePriorities(PriorityQueue queue, ElementNode list,
+                                                 PQElementPriority* priorities, int count)
+{
+    if (queue->priority_size > 0)
+    {
+        int index = 0;
+        for (ElementNode node = list; node != NULL; node = node->next)
+        {
+            memmove(node->element_priority, priorities[index++], queue->priority_size);
+            node->sequence = takeNextSequence();
+        }
+        return PQ_SUCCESS;
+    }
+
+    // copy all the priorities first, so no node is changed if a copy fails
+    PQElementPriority* new_priorities = (PQElementPriority*)malloc(count * sizeof(PQElementPriority));
+    if (new_priorities == NULL && count > 0)
+    {
+        return PQ_OUT_OF_MEMORY;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        new_priorities[i] = COPY_PRIORITY(queue, priorities[i]);
+        if (new_priorities[i] == NULL)
+        {
+            while (i-- > 0)
+            {
+                FREE_PRIORITY(queue, new_priorities[i]);
+            }
+            free(new_priorities);
+            return PQ_OUT_OF_MEMORY;
+        }
+    }
+
+    int index = 0;
+    for (ElementNode node = list; node != NULL; node = node->next)
+    {
+        FREE_PRIORITY(queue, node->element_priority);
+        node->element_priority = new_priorities[index++];
+        node->sequence = takeNextSequence();
+    }
+
+    free(new_priorities);
+    return PQ_SUCCESS;
+}
+
+ElementNode getFirstElementNode(PriorityQueue queue)
+{
+    if (queue->engine == PQ_ENGINE_HEAP)
+    {
+        return queue->heap_size == 0 ? NULL : queue->heap[0];
+    }
+
+    if (queue->engine == PQ_ENGINE_PAIRING)
+    {
+        return queue->pairing_root;
+    }
+
+    return queue->element_list;
+}
+
+ElementNode getLastElementNode(PriorityQueue queue)
+{
+    if (queue->engine == PQ_ENGINE_HEAP)
+    {
+        return heapGetLastNode(queue);
+    }
+
+    assert(queue->engine == PQ_ENGINE_SORTED_LIST);
+    return queue->last_element;
+}
+
+static void evictElementNode(PriorityQueue queue, ElementNode node)
+{
+    unlinkElementNode(queue, node);
+    if (queue->evict_element != NULL)
+    {
+        queue->evict_element(node->element_data, node->element_priority);
+    }
+    freeElementNode(queue, node);
+}
+
+PriorityQueueResult makeRoomForEntry(PriorityQueue queue, PQElement element, PQElementPriority priority,
+                                     bool* is_evicted)
+{
+    *is_evicted = false;
+    if (queue->capacity == 0 || queue->size < queue->capacity)
+    {
+        return PQ_SUCCESS;
+    }
+
+    // the removed entries do not count in the capacity, and must not be evicted
+    compactElementNodes(queue);
+    if (queue->size < queue->capacity)
+    {
+        return PQ_SUCCESS;
+    }
+
+    if (queue->overflow_policy == PQ_OVERFLOW_REJECT)
+    {
+        return PQ_QUEUE_FULL;
+    }
+
+    // a new entry comes after all the entries with its priority
+    ElementNode last_node = getLastElementNode(queue);
+    if (COMPARE_PRIORITIES(queue, priority, last_node->element_priority) <= EQUALS_PRIORITY)
+    {
+        if (queue->evict_element != NULL)
+        {
+            queue->evict_element(element, priority);
+        }
+        *is_evicted = true;
+        return PQ_SUCCESS;
+    }
+
+    evictElementNode(queue, last_node);
+    return PQ_SUCCESS;
+}
+
+void evictOverflowElementNodes(PriorityQueue queue)
+{
+    if (queue->capacity == 0 || queue->size <= queue->capacity)
+    {
+        return;
+    }
+
+    compactElementNodes(queue);
+    while (queue->size > queue->capacity)
+    {
+        evictElementNode(queue, getLastElementNode(queue));
+    }
+
+    assert(isSizeConsistent(queue));
+}
+
+static bool isElementNodeMatch(PriorityQueue queue, ElementNode node, PQElement element, PQElementPriority priority)
+{
+    PQ_STATS_COUNT(queue, nodes_visited);
+    return !node->is_removed && EQUAL_ELEMENTS(queue, node->element_data, element) &&
+           (priority == NULL || COMPARE_PRIORITIES(queue, node->element_priority, priority) == EQUALS_PRIORITY);
+}
+
+ElementNode findElementNode(PriorityQueue queue, PQElement element, PQElementPriority priority)
+{
+    if (queue->buckets != NULL)
+    {
+        return hashFindNode(queue, element, priority);
+    }
+
+    if (queue->engine == PQ_ENGINE_HEAP)
+    {
+        // the heap is not sorted, so look for the match that comes first
+        ElementNode found_node = NULL;
+        for (int i = 0; i < queue->heap_size; i++)
+        {
+            ElementNode node = queue->heap[i];
+            if (isElementNodeMatch(queue, node, element, priority) &&
+                (found_node == NULL || compareElementNodes(queue, node, found_node) > 0))
+            {
+                found_node = node;
+            }
+        }
+        return found_node;
+    }
+
+    if (queue->engine == PQ_ENGINE_PAIRING)
+    {
+        ElementNode found_node = NULL;
+        for (ElementNode node = queue->pairing_root; node != NULL; node = pairingNextNode(queue->pairing_root, node))
+        {
+            if (isElementNodeMatch(queue, node, element, priority) &&
+                (found_node == NULL || compareElementNodes(queue, node, found_node) > 0))
+            {
+                found_node = node;
+            }
+        }
+        return found_node;
+    }
+
+    for (ElementNode node = queue->element_list; node != NULL; node = node->next)
+    {
+        if (isElementNodeMatch(queue, node, element, priority))
+        {
+            return node;
+        }
+    }
+
+    return NULL;
+}
+
+// Sorts the indices of the pairs from the highest priority to the lowest, keeping the array order of equal ones
+static void sortPairIndices(PriorityQueue queue, PQElementPriority* priorities, int* indices, int* buffer,
+                            int count)
+{
+    for (int width = 1; width < count; width *= 2)
+    {
+        for (int start = 0; start < count; start += 2 * width)
+        {
+            int middle = start + width < count ? start + width : count;
+            int end = start + 2 * width < count ? start + 2 * width : count;
+            int first = start;
+            int second = middle;
+            for (int i = start; i < end; i++)
+            {
+                if (second >= end || (first < middle &&
+                    COMPARE_PRIORITIES(queue, priorities[indices[first]], priorities[indices[second]]) >= 0))
+                {
+                    buffer[i] = indices[first++];
+                }
+                else
+                {
+                    buffer[i] = indices[second++];
+                }
+            }
+        }
+        memcpy(indices, buffer, count * sizeof(int));
+    }
+}
+
+// Gives the node to the pair it belongs to, keeping the nodes of equal pairs in the queue order.
+// Returns whether a pair that had no node got one.
+static bool addFoundNode(PriorityQueue queue, PQElement* elements, PQElementPriority* priorities, int* indices,
+                         int count, ElementNode* nodes, ElementNode node)
+{
+    // find the first pair with the priority of the node
+    int low = 0;
+    int high = count;
+    while (low < high)
+    {
+        int middle = low + (high - low) / 2;
+        if (COMPARE_PRIORITIES(queue, priorities[indices[middle]], node->element_priority) > 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    // the node takes the place of a later node of an equal pair, that moves on to the next equal pair
+    for (int i = low; i < count &&
+         COMPARE_PRIORITIES(queue, priorities[indices[i]], node->element_priority) == EQUALS_PRIORITY; i++)
+    {
+        ElementNode* pair_node = &nodes[indices[i]];
+        if (!EQUAL_ELEMENTS(queue, node->element_data, elements[indices[i]]))
+        {
+            continue;
+        }
+
+        if (*pair_node == NULL)
+        {
+            *pair_node = node;
+            return true;
+        }
+
+        if (compareElementNodes(queue, node, *pair_node) > 0)
+        {
+            ElementNode later_node = *pair_node;
+            *pair_node = node;
+            node = later_node;
+        }
+    }
+
+    return false;
+}
+
+PriorityQueueResult findElementNodes(PriorityQueue queue, PQElement* elements, PQElementPriority* priorities,
+                                     int count, ElementNode* nodes)
+{
+    int* indices = (int*)malloc(2 * count * sizeof(int));
+    if (indices == NULL && count > 0)
+    {
+        return PQ_OUT_OF_MEMORY;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        indices[i] = i;
+        nodes[i] = NULL;
+    }
+    sortPairIndices(queue, priorities, indices, indices + count, count);
+
+    // the list engine walks in the queue order, so it can stop once every pair has a node
+    int found_count = 0;
+    if (queue->engine == PQ_ENGINE_SORTED_LIST)
+    {
+        for (ElementNode node = queue->element_list; node != NULL && found_count < count; node = node->next)
+        {
+            PQ_STATS_COUNT(queue, nodes_visited);
+            if (!node->is_removed && addFoundNode(queue, elements, priorities, indices, count, nodes, node))
+            {
+                found_count++;
+            }
+        }
+    }
+    else if (queue->engine == PQ_ENGINE_HEAP)
+    {
+        for (int i = 0; i < queue->heap_size; i++)
+        {
+            PQ_STATS_COUNT(queue, nodes_visited);
+            if (!queue->heap[i]->is_removed)
+            {
+                addFoundNode(queue, elements, priorities, indices, count, nodes, queue->heap[i]);
+            }
+        }
+    }
+    else
+    {
+        for (ElementNode node = queue->pairing_root; node != NULL; node = pairingNextNode(queue->pairing_root, node))
+        {
+            PQ_STATS_COUNT(queue, nodes_visited);
+            if (!node->is_removed)
+            {
+                addFoundNode(queue, elements, priorities, indices, count, nodes, node);
+            }
+        }
+    }
+    free(indices);
+
+    for (int i = 0; i < count; i++)
+    {
+        if (nodes[i] == NULL)
+        {
+            return PQ_ELEMENT_DOES_NOT_EXISTS;
+        }
+    }
+
+    return PQ_SUCCESS;
+}
+
+ElementNode getElementList(PriorityQueue queue)
+{
+    if (!queue->is_element_list_valid)
+    {
+        queue->element_list = queue->engine == PQ_ENGINE_HEAP ? heapBuildElementList(queue) :
+                                                                pairingBuildElementList(queue);
+        queue->is_element_list_valid = true;
+    }
+
+    return queue->element_list;
+}
+
+#ifndef NDEBUG
+bool isSizeConsistent(PriorityQueue queue)
+{
+    int removed_count = 0;
+    if (queue->engine == PQ_ENGINE_HEAP)
+    {
+        for (int i = 0; i < queue->heap_size; i++)
+        {
+            if (queue->heap[i]->heap_index != i ||
+                (queue->last_heap != NULL && queue->last_heap[queue->heap[i]->last_heap_index] != queue->heap[i]))
+            {
+                return false;
+            }
+            removed_count += queue->heap[i]->is_removed;
+        }
+        return queue->heap_size == queue->size && removed_count == queue->removed_count;
+    }
+
+    if (queue->engine == PQ_ENGINE_PAIRING)
+    {
+        int nodes_count = 0;
+        for (ElementNode node = queue->pairing_root; node != NULL; node = pairingNextNode(queue->pairing_root, node))
+        {
+            if (node->child != NULL && node->child->prev != node)
+            {
+                return false;
+            }
+            nodes_count++;
+            removed_count += node->is_removed;
+        }
+        return nodes_count == queue->size && removed_count == queue->removed_count;
+    }
+
+    int elements_size = 0;
+    for (ElementNode node = queue->element_list; node != NULL; node = node->next)
+    {
+        if (node->next == NULL ? queue->last_element != node : node->next->prev != node)
+        {
+            return false;
+        }
+        elements_size++;
+        removed_count += node->is_removed;
+    }
+
+    return elements_size == queue->size && removed_count == queue->removed_count;
+}
+#endif
@@ -4,12 +4,23 @@
 #include <stdbool.h>
 #include "priority_queue.h"
 
+#define DEFAULT_HEAP_ARITY 4
+
 /** Type for defining the element node */
 typedef struct element_t
 {
     PQElement element_data;
     PQElementPriority element_priority;
     struct element_t* next;
+    struct element_t* prev;
+    unsigned long sequence;
+    int heap_index;
+    int last_heap_index;
+    unsigned int hash_value;
+    struct element_t* hash_next;
+    bool is_removed;
+    struct element_t* child;
+    struct element_t* sibling;
 } *ElementNode;
 
 struct PriorityQueue_t
@@ -20,15 +31,57 @@ struct PriorityQueue_t
     CopyPQElementPriority copy_priority;
     FreePQElementPriority free_priority;
     ComparePQElementPriorities compare_priorities;
+    HashPQElement hash_element;
+    EvictPQElement evict_element;
+    int capacity;
+    PQOverflowPolicy overflow_policy;
+    ElementNode* buckets;
+    int bucket_count;
+    PQEngine engine;
+    int heap_arity;
+    ElementNode* heap;
+    ElementNode* last_heap;
+    int heap_size;
+    int heap_capacity;
+    ElementNode pairing_root;
+    ElementNode free_nodes;
+    ElementNode last_free_node;
+    int free_node_count;
+    struct node_slab_t* slabs;
+    struct node_slab_t* last_slab;
+    int pool_capacity;
+    int element_size;
+    int priority_size;
+    int node_size;
     ElementNode element_list;
+    ElementNode last_element;
+    bool is_element_list_valid;
+    int size;
+    int removed_count;
+    int max_removed_percent;
+    unsigned long version;
     ElementNode iterator;
     bool is_iterator_undefined;
+    struct PriorityQueue_t* shared_prev;
+    struct PriorityQueue_t* shared_next;
+    bool owns_storage;
+#ifdef PQ_ENABLE_STATS
+    PQStats stats;
+#endif
 };
 
+/**
+*   setInlineSizes: Sets the sizes of the elements and priorities that the queue stores inside its nodes
+*   (0 for the ones allocated by the copy functions), and the size of every node with its inline data.
+*   Must be called before the first node of the queue is allocated.
+*/
+void setInlineSizes(PriorityQueue queue, int element_size, int priority_size);
+
 /**
 *   createNewElementNode: Create new element node.
-*   allocate new place and initilise the element_data to elemet and the element_priority to priority
-*   The next pointer of the new element is NULL
+*   take a node from the node pool of the queue and initilise the element_data to elemet and the element_priority to priority
+*   The next pointer of the new element is NULL, and the node gets the next insertion sequence number.
+*   If the queue has a hash index, the hash of the element is saved in the node.
 *
 * @param queue - The priority queue for the copy functions
 * @param element - The element data to copy to the new element node.
@@ -39,38 +92,277 @@ struct PriorityQueue_t
 */
 ElementNode createNewElementNode(PriorityQueue queue, PQElement element, PQElementPriority priority);
 
+/**
+*   adoptNewElementNode: Create new element node that takes the ownership of element and priority,
+*   without copying them. Otherwise the same as createNewElementNode.
+*   Inline elements and priorities are copied into the node, and the caller frees them with
+*   releaseAdoptedData once the node is linked.
+*
+* @return
+* 	NULL if a NULL was sent to the function or if an allocation failed (element and priority are
+* 	not freed in that case).
+* 	ElementNode new_element when the create success.
+*/
+ElementNode adoptNewElementNode(PriorityQueue queue, PQElement element, PQElementPriority priority);
+
 /**
 *   freeElementNode: Free the element node, include the element_data, element_priority.
+*   The node itself is returned to the node pool of the queue.
 *
 * @param queue - The priority queue for the copy functions
 * @param element - The element data to copy to the new element node.
-* 
+*
 */
 void freeElementNode(PriorityQueue queue, ElementNode element);
 
 /**
-*   removeElementNode: Remove and free element node from the element list of the queue.
-*   free the element to remove and connect the element before with the next element.
+*   releaseAdoptedData: Frees the element and priority given to adoptNewElementNode that were
+*   copied inline into the node. The ones the node took as they are are not freed.
+*/
+void releaseAdoptedData(PriorityQueue queue, PQElement element, PQElementPriority priority);
+
+/**
+*   takeElementNodeData: Gives the element and priority of a node to the caller, who frees them with the
+*   free functions. Inline elements and priorities are copied out with the copy functions.
+*   The node is not changed, and must be returned to the node pool without freeing its data.
 *
-* @param queue - The priority queue for the copy functions
-* @param element_before - The element before the element to remove.
 * @return
-* 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters
-* 	PQ_SUCCESS the element node removed successfully
+* 	PQ_OUT_OF_MEMORY if copying an inline element or priority failed. Nothing is given in that case.
+* 	PQ_SUCCESS otherwise.
 */
-PriorityQueueResult removeElementNode(PriorityQueue queue, ElementNode element_before);
+PriorityQueueResult takeElementNodeData(PriorityQueue queue, ElementNode node, PQElement* element,
+                                        PQElementPriority* priority);
 
 /**
 *   copyElementList: copy element list to new element list.
 *   allocate the new element nodes in the new list and copy to them the original element data and priority
+*   The new nodes are not added to any hash index.
 *
 * @param queue - The priority queue to copy from.
+* @param new_queue - The priority queue that the new nodes are allocated for.
 * @return
-* 	NULL if a NULL was sent as one of the parameters
+* 	NULL if a NULL was sent as one of the parameters, the list is empty or an allocation failed
 * 	ElementNode new_element_list - the new element list that copy
 */
-ElementNode copyElementList(PriorityQueue queue);
+ElementNode copyElementList(PriorityQueue queue, PriorityQueue new_queue);
 
+/**
+*   compareElementNodes: Compares the order of two element nodes in the queue.
+*   The node with the higher priority comes first, and between equal priorities the node
+*   that was inserted first comes first.
+*
+* @return
+* 	A positive integer if first comes before second.
+* 	A negative integer if second comes before first.
+*/
+int compareElementNodes(PriorityQueue queue, ElementNode first, ElementNode second);
 
+/**
+*   sortElementList: Sorts a list of element nodes (linked by next) by their order in the queue.
+*   The sort is a merge sort and does not allocate.
+*
+* @param queue - The priority queue for the compare function
+* @param list - The first node of the list to sort.
+* @return
+* 	The first node of the sorted list.
+*/
+ElementNode sortElementList(PriorityQueue queue, ElementNode list);
+
+/**
+*   linkElementNode: Links an element node into the storage of the queue, in its place by its order.
+*   The size and the hash index of the queue are updated.
+*
+* @param queue - The priority queue to link the node into.
+* @param node - The node to link. Its data, priority and sequence must be set.
+* @return
+* 	PQ_OUT_OF_MEMORY if the storage of the queue could not grow.
+* 	PQ_SUCCESS the node linked successfully.
+*/
+PriorityQueueResult linkElementNode(PriorityQueue queue, ElementNode node);
+
+/**
+*   linkElementNodes: Links a list of new element nodes (linked by next) into the storage of the queue,
+*   like calling linkElementNode on each of them, but reorders the storage once for all of them:
+*   the sorted list engine sorts the new nodes (unless they are already in order) and merges them into the list, and the heap engine
+*   rebuilds the heap when the new nodes are many compared to the heap.
+*   The size and the hash index of the queue are updated.
+*
+* @param queue - The priority queue to link the nodes into.
+* @param list - The first node of the list. The data, priority and sequence of the nodes must be set.
+* @param count - The number of nodes in the list.
+* @return
+* 	PQ_OUT_OF_MEMORY if the storage of the queue could not grow. No node is linked in that case.
+* 	PQ_SUCCESS the nodes linked successfully.
+*/
+PriorityQueueResult linkElementNodes(PriorityQueue queue, ElementNode list, int count);
+
+/**
+*   meldElementTree: Links a whole pairing tree of nodes (the heap of another pairing queue) into the heap of
+*   a pairing queue, in O(1) time when the queue has no hash index. The size and the hash index of the
+*   queue are updated.
+*
+* @param queue - The pairing priority queue to link the nodes into.
+* @param root - The root of the tree to link.
+* @param count - The number of nodes in the tree.
+*/
+void meldElementTree(PriorityQueue queue, ElementNode root, int count);
+
+/**
+*   unlinkElementNode: Unlinks an element node from the storage of the queue without freeing it.
+*   The size and the hash index of the queue are updated.
+*
+* @param queue - The priority queue that holds the node.
+* @param node - The node to unlink.
+*/
+void unlinkElementNode(PriorityQueue queue, ElementNode node);
+
+/**
+*   markElementNodeRemoved: Marks a linked node as removed (a tombstone) without unlinking it, for the
+*   lazy removal of the queue. The node leaves the hash index, and is skipped by the lookups and the
+*   iteration. When the removed nodes become more than max_removed_percent of the nodes, they are all
+*   unlinked and freed (see compactElementNodes). Otherwise only the removed nodes at the start of the
+*   queue are freed (see freeFirstRemovedNodes).
+*/
+void markElementNodeRemoved(PriorityQueue queue, ElementNode node);
+
+/**
+*   freeFirstRemovedNodes: Unlinks and frees the removed nodes at the start of the queue, so the first node of
+*   the queue is not removed. Called after every operation that may change the first node of a queue with
+*   removed nodes.
+*/
+void freeFirstRemovedNodes(PriorityQueue queue);
+
+/**
+*   compactElementNodes: Unlinks and frees all the removed nodes of the queue.
+*/
+void compactElementNodes(PriorityQueue queue);
+
+/**
+*   skipRemovedNodes: Returns the first node from node on (by next) that is not removed, or NULL.
+*/
+ElementNode skipRemovedNodes(ElementNode node);
+
+/**
+*   relinkElementNode: Moves a linked node to its new place after its priority was changed.
+*   The node is considered as reinserted, so it gets a new insertion sequence number.
+*   The node is not reallocated, and the size and the hash index of the queue do not change.
+*
+* @param queue - The priority queue that holds the node.
+* @param node - The node to move.
+* @param is_moved_up - true if the new priority is higher than the old one, so the node can only
+*       have moved towards the first node. Engines use it to skip looking at the nodes after it.
+*/
+void relinkElementNode(PriorityQueue queue, ElementNode node, bool is_moved_up);
+
+/**
+*   replaceElementNodePriority: Replaces the priority of a linked node with a copy of priority
+*   and moves the node to its new place (see relinkElementNode).
+*
+* @return
+* 	PQ_OUT_OF_MEMORY if copying the priority failed. The node is not changed in that case.
+* 	PQ_SUCCESS otherwise.
+*/
+PriorityQueueResult replaceElementNodePriority(PriorityQueue queue, ElementNode node, PQElementPriority priority);
+
+/**
+*   replaceElementNodePriorities: Replaces the priorities of a list of unlinked nodes (linked by next) with
+*   copies of priorities, in the list order, and gives the nodes new insertion sequence numbers in that order.
+*   The nodes are not linked, so the caller links them all at once (see linkElementNodes).
+*
+* @return
+* 	PQ_OUT_OF_MEMORY if copying a priority failed. No node is changed in that case.
+* 	PQ_SUCCESS otherwise.
+*/
+PriorityQueueResult replaceElementNodePriorities(PriorityQueue queue, ElementNode list,
+                                                 PQElementPriority* priorities, int count);
+
+/**
+*   getFirstElementNode: Returns the node with the highest order in the queue.
+*
+* @return
+* 	NULL if the queue is empty.
+* 	The first node otherwise.
+*/
+ElementNode getFirstElementNode(PriorityQueue queue);
+
+/**
+*   getLastElementNode: Returns the node with the lowest order in the queue, in O(1).
+*   The sorted list engine keeps it always, and the heap engine only when the queue evicts (it is needed
+*   only to evict, see PQOptions.overflow_policy).
+*
+* @return
+* 	NULL if the queue is empty.
+* 	The last node otherwise.
+*/
+ElementNode getLastElementNode(PriorityQueue queue);
+
+/**
+*   makeRoomForEntry: Makes room for a new entry in a bounded queue that is at its capacity.
+*   If the queue evicts, the entry that comes last among the queue entries and the new entry is evicted:
+*   a queue entry is unlinked, passed to the evict function and freed, while for the new entry only
+*   the evict function is called, and is_evicted is set.
+*
+* @param queue - The priority queue to insert the entry into.
+* @param element - The element of the new entry.
+* @param priority - The priority of the new entry.
+* @param is_evicted - Pointer to assign whether the new entry was evicted into.
+* @return
+* 	PQ_QUEUE_FULL if the queue is full and rejects inserts when full.
+* 	PQ_SUCCESS if there is room for the new entry, or it was evicted.
+*/
+PriorityQueueResult makeRoomForEntry(PriorityQueue queue, PQElement element, PQElementPriority priority,
+                                     bool* is_evicted);
+
+/**
+*   evictOverflowElementNodes: Evicts the last entries of a bounded queue until it is within its capacity.
+*/
+void evictOverflowElementNodes(PriorityQueue queue);
+
+/**
+*   findElementNode: Finds the first node (by the queue order) that its element is equal to element,
+*   and if priority is not NULL, that its priority is equal to priority.
+*
+* @return
+* 	NULL if there is no such node.
+* 	The found node otherwise.
+*/
+ElementNode findElementNode(PriorityQueue queue, PQElement element, PQElementPriority priority);
+
+/**
+*   findElementNodes: Finds the nodes of count elements with their priorities in one walk over the queue,
+*   like calling findElementNode for every pair in the array order, where a node that was found is not
+*   found again (so two equal pairs find two nodes). Takes O(n log k) instead of the O(n * k) of k calls.
+*
+* @param nodes - An array of count nodes, to assign the node of every pair into.
+* @return
+* 	PQ_OUT_OF_MEMORY if an allocation failed.
+* 	PQ_ELEMENT_DOES_NOT_EXISTS if one of the pairs has no node.
+* 	PQ_SUCCESS otherwise.
+*/
+PriorityQueueResult findElementNodes(PriorityQueue queue, PQElement* elements, PQElementPriority* priorities,
+                                     int count, ElementNode* nodes);
+
+/**
+*   getElementList: Returns the first node of the element list of the queue, which holds all the nodes
+*   in the queue order linked by next. Engines that do not keep a sorted list build it here,
+*   and it stays valid until the next change of the queue.
+*
+* @return
+* 	NULL if the queue is empty.
+* 	The first node of the element list otherwise.
+*/
+ElementNode getElementList(PriorityQueue queue);
+
+#ifndef NDEBUG
+/**
+*   isSizeConsistent: Debug check that the size and removed counters of the queue match the nodes
+*   in its storage. Walks all the nodes, so it is used only in assertions.
+*
+* @return
+* 	true if the counter matches the storage.
+* 	false otherwise.
+*/
+bool isSizeConsistent(PriorityQueue queue);
+#endif
 
 #endif /* PQ_HELPER_H */
\ No newline at end of file
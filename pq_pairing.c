@@ -0,0 +1,185 @@
+#include <stdlib.h>
+#include "priority_queue.h"
+#include "pq_helper.h"
+#include "pq_pairing.h"
+
+/** Melds two trees into one, and returns its root. The node that comes first becomes the root */
+static ElementNode meldNodes(PriorityQueue queue, ElementNode first, ElementNode second)
+{
+    if (first == NULL)
+    {
+        return second;
+    }
+    if (second == NULL)
+    {
+        return first;
+    }
+
+    if (compareElementNodes(queue, first, second) < 0)
+    {
+        ElementNode temp = first;
+        first = second;
+        second = temp;
+    }
+
+    // second becomes the first child of first
+    second->sibling = first->child;
+    if (first->child != NULL)
+    {
+        first->child->prev = second;
+    }
+    second->prev = first;
+    first->child = second;
+
+    first->sibling = NULL;
+    first->prev = NULL;
+    return first;
+}
+
+/** Melds a list of sibling trees into one tree (two pass pairing), and returns its root */
+static ElementNode meldSiblings(PriorityQueue queue, ElementNode first)
+{
+    // meld the siblings in pairs from left to right, keeping the results in reverse order
+    ElementNode pairs = NULL;
+    while (first != NULL)
+    {
+        ElementNode second = first->sibling;
+        ElementNode next_first = second != NULL ? second->sibling : NULL;
+
+        first->sibling = NULL;
+        first->prev = NULL;
+        if (second != NULL)
+        {
+            second->sibling = NULL;
+            second->prev = NULL;
+        }
+
+        ElementNode pair = meldNodes(queue, first, second);
+        pair->sibling = pairs;
+        pairs = pair;
+        first = next_first;
+    }
+
+    // meld the pairs from right to left
+    ElementNode root = NULL;
+    while (pairs != NULL)
+    {
+        ElementNode next_pair = pairs->sibling;
+        pairs->sibling = NULL;
+        root = meldNodes(queue, root, pairs);
+        pairs = next_pair;
+    }
+
+    return root;
+}
+
+/** Detaches a node that is not the root from its parent and siblings, with its subtree */
+static void cutNode(ElementNode node)
+{
+    if (node->prev->child == node)
+    {
+        node->prev->child = node->sibling;
+    }
+    else
+    {
+        node->prev->sibling = node->sibling;
+    }
+
+    if (node->sibling != NULL)
+    {
+        node->sibling->prev = node->prev;
+    }
+
+    node->prev = NULL;
+    node->sibling = NULL;
+}
+
+void pairingInsertNode(PriorityQueue queue, ElementNode node)
+{
+    node->child = NULL;
+    node->sibling = NULL;
+    node->prev = NULL;
+    queue->pairing_root = meldNodes(queue, queue->pairing_root, node);
+}
+
+void pairingMeldTree(PriorityQueue queue, ElementNode root)
+{
+    queue->pairing_root = meldNodes(queue, queue->pairing_root, root);
+}
+
+void pairingRemoveNode(PriorityQueue queue, ElementNode node)
+{
+    ElementNode children = node->child;
+    node->child = NULL;
+
+    if (node == queue->pairing_root)
+    {
+        queue->pairing_root = meldSiblings(queue, children);
+        return;
+    }
+
+    cutNode(node);
+    queue->pairing_root = meldNodes(queue, queue->pairing_root, meldSiblings(queue, children));
+}
+
+void pairingFixNode(PriorityQueue queue, ElementNode node, bool is_moved_up)
+{
+    if (is_moved_up)
+    {
+        // the node still comes before its children, so its whole subtree moves to the root
+        if (node != queue->pairing_root)
+        {
+            cutNode(node);
+            queue->pairing_root = meldNodes(queue, queue->pairing_root, node);
+        }
+        return;
+    }
+
+    pairingRemoveNode(queue, node);
+    pairingInsertNode(queue, node);
+}
+
+ElementNode pairingNextNode(ElementNode root, ElementNode node)
+{
+    if (node == NULL)
+    {
+        return root;
+    }
+
+    // walk the tree as a binary tree: child on the left and sibling on the right
+    if (node->child != NULL)
+    {
+        return node->child;
+    }
+
+    while (node != root)
+    {
+        if (node->sibling != NULL)
+        {
+            return node->sibling;
+        }
+
+        // go up to the parent: back over the siblings, and then from the first child
+        while (node->prev->child != node)
+        {
+            node = node->prev;
+        }
+        node = node->prev;
+    }
+
+    return NULL;
+}
+
+ElementNode pairingBuildElementList(PriorityQueue queue)
+{
+    struct element_t list_head;
+    ElementNode list_tail = &list_head;
+    for (ElementNode node = queue->pairing_root; node != NULL; node = pairingNextNode(queue->pairing_root, node))
+    {
+        list_tail->next = node;
+        list_tail = node;
+    }
+    list_tail->next = NULL;
+
+    return sortElementList(queue, list_head.next);
+}
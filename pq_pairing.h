@@ -0,0 +1,70 @@
+#ifndef PQ_PAIRING_H
+#define PQ_PAIRING_H
+
+#include <stdbool.h>
+#include "priority_queue.h"
+#include "pq_helper.h"
+
+/**
+*   Pairing heap engine.
+*   The nodes form a tree where every node comes before its children. The first child of a node is
+*   linked by child, the next child of the same parent by sibling, and prev links a node to its
+*   previous sibling, or to its parent if it is the first child. next is not used by the tree,
+*   so the element list of the queue can be built without changing it.
+*/
+
+/**
+*   pairingInsertNode: Inserts a node into the heap, in O(1) time.
+*
+* @param queue - The priority queue of the heap.
+* @param node - The node to insert.
+*/
+void pairingInsertNode(PriorityQueue queue, ElementNode node);
+
+/**
+*   pairingMeldTree: Melds a tree of nodes (the whole heap of another queue) into the heap, in O(1) time.
+*
+* @param queue - The priority queue of the heap.
+* @param root - The root of the tree to meld.
+*/
+void pairingMeldTree(PriorityQueue queue, ElementNode root);
+
+/**
+*   pairingRemoveNode: Removes a node from the heap without freeing it, in O(log n) amortised time.
+*
+* @param queue - The priority queue of the heap.
+* @param node - The node to remove.
+*/
+void pairingRemoveNode(PriorityQueue queue, ElementNode node);
+
+/**
+*   pairingFixNode: Moves a node to its place after its order was changed.
+*   If the node can only have moved towards the root (decrease-key), it takes O(1) time,
+*   and O(log n) amortised time otherwise.
+*
+* @param queue - The priority queue of the heap.
+* @param node - The node that its order was changed.
+* @param is_moved_up - true if the node now comes before where it was.
+*/
+void pairingFixNode(PriorityQueue queue, ElementNode node, bool is_moved_up);
+
+/**
+*   pairingNextNode: Walks over all the nodes of a tree in no particular order, without changing them.
+*
+* @param root - The root of the tree, usually the root of the heap of a queue.
+* @param node - The current node of the walk, or NULL to start it.
+* @return
+* 	NULL if the walk is over.
+* 	The next node of the walk otherwise.
+*/
+ElementNode pairingNextNode(ElementNode root, ElementNode node);
+
+/**
+*   pairingBuildElementList: Links all the nodes of the heap by next, in the queue order.
+*
+* @return
+* 	The first node of the built list, or NULL if the heap is empty.
+*/
+ElementNode pairingBuildElementList(PriorityQueue queue);
+
+#endif /* PQ_PAIRING_H */
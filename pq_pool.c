@@ -0,0 +1,205 @@
+#include <stdlib.h>
+#include <assert.h>
+#include "priority_queue.h"
+#include "pq_helper.h"
+#include "pq_pool.h"
+
+#define MIN_SLAB_NODES 16
+#define MAX_SLAB_NODES 1024
+#define FREE_NODE_INDEX -1
+
+/**
+* A block of nodes allocated together. The free nodes of all the slabs are linked by next.
+* The queue keeps the last slab and the last free node as well (the last free node only while there are
+* free nodes), so poolMoveNodes splices both lists in O(1).
+* The nodes are node_size bytes apart, to leave room for the inline data of the queue after every node.
+*/
+struct node_slab_t
+{
+    struct node_slab_t* next;
+    int node_count;
+    int node_size;
+    struct element_t nodes[];
+};
+
+static ElementNode getSlabNode(struct node_slab_t* slab, int index)
+{
+    return (ElementNode)((char*)slab->nodes + (size_t)index * slab->node_size);
+}
+
+static PriorityQueueResult allocateSlab(PriorityQueue queue, int node_count)
+{
+    struct node_slab_t* slab = (struct node_slab_t*)malloc(sizeof(struct node_slab_t) +
+                                                           (size_t)node_count * queue->node_size);
+    if (slab == NULL)
+    {
+        return PQ_OUT_OF_MEMORY;
+    }
+
+    slab->node_count = node_count;
+    slab->node_size = queue->node_size;
+    if (queue->slabs == NULL)
+    {
+        queue->last_slab = slab;
+    }
+    slab->next = queue->slabs;
+    queue->slabs = slab;
+    queue->pool_capacity += node_count;
+
+    // push the nodes in reverse, so they are taken in address order
+    for (int i = node_count - 1; i >= 0; i--)
+    {
+        poolFreeNode(queue, getSlabNode(slab, i));
+    }
+
+    return PQ_SUCCESS;
+}
+
+ElementNode poolAllocateNode(PriorityQueue queue)
+{
+    if (queue->free_nodes == NULL)
+    {
+        // grow with the pool, but keep slabs small enough to be freed by poolShrink
+        int node_count = queue->pool_capacity;
+        if (node_count < MIN_SLAB_NODES)
+        {
+            node_count = MIN_SLAB_NODES;
+        }
+        else if (node_count > MAX_SLAB_NODES)
+        {
+            node_count = MAX_SLAB_NODES;
+        }
+
+        if (allocateSlab(queue, node_count) != PQ_SUCCESS)
+        {
+            return NULL;
+        }
+    }
+
+    ElementNode node = queue->free_nodes;
+    queue->free_nodes = node->next;
+    queue->free_node_count--;
+    return node;
+}
+
+void poolFreeNode(PriorityQueue queue, ElementNode node)
+{
+    node->heap_index = FREE_NODE_INDEX;
+    if (queue->free_nodes == NULL)
+    {
+        queue->last_free_node = node;
+    }
+    node->next = queue->free_nodes;
+    queue->free_nodes = node;
+    queue->free_node_count++;
+}
+
+PriorityQueueResult poolReserve(PriorityQueue queue, int node_count)
+{
+    while (queue->free_node_count < node_count)
+    {
+        int missing_nodes = node_count - queue->free_node_count;
+        if (allocateSlab(queue, missing_nodes < MAX_SLAB_NODES ? missing_nodes : MAX_SLAB_NODES) != PQ_SUCCESS)
+        {
+            return PQ_OUT_OF_MEMORY;
+        }
+    }
+
+    return PQ_SUCCESS;
+}
+
+void poolMoveNodes(PriorityQueue queue, PriorityQueue source)
+{
+    if (source->slabs == NULL)
+    {
+        return;
+    }
+
+    // put the slabs of source before the slabs of queue, and its free nodes before the free nodes of queue
+    if (queue->slabs == NULL)
+    {
+        queue->last_slab = source->last_slab;
+    }
+    source->last_slab->next = queue->slabs;
+    queue->slabs = source->slabs;
+    queue->pool_capacity += source->pool_capacity;
+
+    if (source->free_nodes != NULL)
+    {
+        if (queue->free_nodes == NULL)
+        {
+            queue->last_free_node = source->last_free_node;
+        }
+        source->last_free_node->next = queue->free_nodes;
+        queue->free_nodes = source->free_nodes;
+        queue->free_node_count += source->free_node_count;
+    }
+
+    source->slabs = NULL;
+    source->last_slab = NULL;
+    source->free_nodes = NULL;
+    source->free_node_count = 0;
+    source->pool_capacity = 0;
+}
+
+static bool isSlabFree(struct node_slab_t* slab)
+{
+    for (int i = 0; i < slab->node_count; i++)
+    {
+        if (getSlabNode(slab, i)->heap_index != FREE_NODE_INDEX)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void poolShrink(PriorityQueue queue)
+{
+    // free the unused slabs and rebuild the free list from the slabs that are left
+    queue->free_nodes = NULL;
+    queue->free_node_count = 0;
+    queue->pool_capacity = 0;
+    queue->last_slab = NULL;
+
+    struct node_slab_t** link = &queue->slabs;
+    while (*link != NULL)
+    {
+        struct node_slab_t* slab = *link;
+        if (isSlabFree(slab))
+        {
+            *link = slab->next;
+            free(slab);
+            continue;
+        }
+
+        queue->pool_capacity += slab->node_count;
+        queue->last_slab = slab;
+        for (int i = slab->node_count - 1; i >= 0; i--)
+        {
+            if (getSlabNode(slab, i)->heap_index == FREE_NODE_INDEX)
+            {
+                poolFreeNode(queue, getSlabNode(slab, i));
+            }
+        }
+        link = &slab->next;
+    }
+}
+
+void poolDestroy(PriorityQueue queue)
+{
+    assert(queue->free_node_count == queue->pool_capacity);
+
+    while (queue->slabs != NULL)
+    {
+        struct node_slab_t* next_slab = queue->slabs->next;
+        free(queue->slabs);
+        queue->slabs = next_slab;
+    }
+
+    queue->last_slab = NULL;
+    queue->free_nodes = NULL;
+    queue->free_node_count = 0;
+    queue->pool_capacity = 0;
+}
@@ -0,0 +1,48 @@
+#ifndef PQ_POOL_H
+#define PQ_POOL_H
+
+#include "priority_queue.h"
+#include "pq_helper.h"
+
+/**
+*   poolAllocateNode: Takes a free node from the node pool of the queue.
+*   When there are no free nodes, a new slab of nodes is allocated.
+*
+* @return
+* 	NULL if a new slab was needed and its allocation failed.
+* 	An uninitialised node otherwise.
+*/
+ElementNode poolAllocateNode(PriorityQueue queue);
+
+/**
+*   poolFreeNode: Returns a node to the node pool of the queue. The node data is not freed.
+*/
+void poolFreeNode(PriorityQueue queue, ElementNode node);
+
+/**
+*   poolReserve: Makes sure the node pool of the queue has at least node_count free nodes.
+*
+* @return
+* 	PQ_OUT_OF_MEMORY if an allocation failed.
+* 	PQ_SUCCESS otherwise.
+*/
+PriorityQueueResult poolReserve(PriorityQueue queue, int node_count);
+
+/**
+*   poolMoveNodes: Moves all the slabs of the node pool of source, with their nodes in use and
+*   their free nodes, into the node pool of queue. The node pool of source is left empty.
+*   Both queues must have the same inline sizes, so their nodes are the same size.
+*/
+void poolMoveNodes(PriorityQueue queue, PriorityQueue source);
+
+/**
+*   poolShrink: Frees the slabs of the node pool of the queue that have no node in use.
+*/
+void poolShrink(PriorityQueue queue);
+
+/**
+*   poolDestroy: Frees all the slabs of the node pool of the queue. All the nodes must be free.
+*/
+void poolDestroy(PriorityQueue queue);
+
+#endif /* PQ_POOL_H */
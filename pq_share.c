@@ -0,0 +1,207 @@
+#include <stdlib.h>
+#include <assert.h>
+#include "priority_queue.h"
+#include "pq_helper.h"
+#include "pq_heap.h"
+#include "pq_hash.h"
+#include "pq_pool.h"
+#include "pq_pairing.h"
+#include "pq_share.h"
+
+static PriorityQueue createEmptyQueue(PriorityQueue queue, int initial_capacity)
+{
+    PQOptions options = {.engine = queue->engine, .heap_arity = queue->heap_arity,
+                         .hash_element = queue->hash_element, .initial_capacity = initial_capacity,
+                         .capacity = queue->capacity, .overflow_policy = queue->overflow_policy,
+                         .evict_element = queue->evict_element, .element_size = queue->element_size,
+                         .priority_size = queue->priority_size, .max_removed_percent = queue->max_removed_percent};
+    return pqCreateWithOptions(queue->copy_element, queue->free_element, queue->equal_elements,
+                               queue->copy_priority, queue->free_priority, queue->compare_priorities, &options);
+}
+
+/** Creates a new queue with a copy of every entry of queue, using the copy functions */
+static PriorityQueue copyQueueEntries(PriorityQueue queue)
+{
+    assert(isSizeConsistent(queue));
+
+    PriorityQueue new_queue = createEmptyQueue(queue, queue->size);
+    if (new_queue == NULL)
+    {
+        return NULL;
+    }
+
+    if (queue->engine == PQ_ENGINE_HEAP)
+    {
+        if (copyElementHeap(queue, new_queue) != PQ_SUCCESS)
+        {
+            pqDestroy(new_queue);
+            return NULL;
+        }
+        new_queue->is_element_list_valid = false;
+    }
+    else if (queue->engine == PQ_ENGINE_PAIRING)
+    {
+        // the copy of a pairing heap is made from its element list, that has the same links in every
+        // queue of the ring, so building it does not change the iteration of the other queues
+        getElementList(queue);
+        new_queue->element_list = copyElementList(queue, new_queue);
+        if (new_queue->element_list == NULL && queue->element_list != NULL)
+        {
+            pqDestroy(new_queue);
+            return NULL;
+        }
+
+        // the nodes come in order, so every one of them becomes a child of the first one
+        for (ElementNode node = new_queue->element_list; node != NULL; node = node->next)
+        {
+            pairingInsertNode(new_queue, node);
+        }
+    }
+    else
+    {
+        new_queue->element_list = copyElementList(queue, new_queue);
+        if (new_queue->element_list == NULL && queue->element_list != NULL)
+        {
+            pqDestroy(new_queue);
+            return NULL;
+        }
+
+        for (ElementNode node = new_queue->element_list; node != NULL; node = node->next)
+        {
+            new_queue->last_element = node;
+        }
+    }
+
+    new_queue->size = queue->size;
+    new_queue->removed_count = queue->removed_count;
+    if (new_queue->buckets != NULL)
+    {
+        hashIndexAllNodes(new_queue);
+    }
+
+    return new_queue;
+}
+
+/**
+* Makes queue use the storage of source, keeping its place in its ring.
+* Only a queue that does not own a shared storage adopts another one, and such a queue gives out no
+* element of the shared storage, so it has no iterator to keep.
+*/
+static void adoptStorage(PriorityQueue queue, const struct PriorityQueue_t* source)
+{
+    struct PriorityQueue_t old_queue = *queue;
+    *queue = *source;
+
+    queue->version = old_queue.version + 1;
+    queue->shared_prev = old_queue.shared_prev;
+    queue->shared_next = old_queue.shared_next;
+    queue->owns_storage = old_queue.owns_storage;
+    queue->iterator = NULL;
+    queue->is_iterator_undefined = true;
+#ifdef PQ_ENABLE_STATS
+    queue->stats = old_queue.stats;
+#endif
+}
+
+static void unlinkFromRing(PriorityQueue queue)
+{
+    queue->shared_prev->shared_next = queue->shared_next;
+    queue->shared_next->shared_prev = queue->shared_prev;
+    queue->shared_prev = queue;
+    queue->shared_next = queue;
+}
+
+bool isStorageShared(PriorityQueue queue)
+{
+    return queue->shared_next != queue;
+}
+
+void shareStorage(PriorityQueue queue, PriorityQueue new_queue)
+{
+    assert(new_queue->size == 0 && !isStorageShared(new_queue));
+
+    hashDestroyIndex(new_queue);
+    poolDestroy(new_queue);
+    heapDestroy(new_queue);
+
+    adoptStorage(new_queue, queue);
+    new_queue->owns_storage = false;
+    new_queue->iterator = NULL;
+    new_queue->is_iterator_undefined = true;
+
+    new_queue->shared_prev = queue;
+    new_queue->shared_next = queue->shared_next;
+    queue->shared_next->shared_prev = new_queue;
+    queue->shared_next = new_queue;
+}
+
+PriorityQueueResult unshareStorage(PriorityQueue queue, bool keep_entries)
+{
+    if (!isStorageShared(queue))
+    {
+        return PQ_SUCCESS;
+    }
+
+    if (!keep_entries || !queue->owns_storage)
+    {
+        PriorityQueue new_storage = keep_entries ? copyQueueEntries(queue) : createEmptyQueue(queue, 0);
+        if (new_storage == NULL)
+        {
+            return PQ_OUT_OF_MEMORY;
+        }
+
+        leaveSharedStorage(queue);
+        adoptStorage(queue, new_storage);
+        queue->owns_storage = true;
+        free(new_storage);
+        return PQ_SUCCESS;
+    }
+
+    // the owner keeps its nodes, and the rest of the ring moves to one copy of them
+    PriorityQueue new_storage = copyQueueEntries(queue);
+    if (new_storage == NULL)
+    {
+        return PQ_OUT_OF_MEMORY;
+    }
+
+    PriorityQueue new_owner = queue->shared_next;
+    unlinkFromRing(queue);
+
+    PriorityQueue ring_member = new_owner;
+    do
+    {
+        adoptStorage(ring_member, new_storage);
+        ring_member = ring_member->shared_next;
+    } while (ring_member != new_owner);
+
+    new_owner->owns_storage = true;
+    free(new_storage);
+
+    return PQ_SUCCESS;
+}
+
+PriorityQueueResult unshareStorageForRead(PriorityQueue queue)
+{
+    if (!isStorageShared(queue) || queue->owns_storage)
+    {
+        return PQ_SUCCESS;
+    }
+
+    return unshareStorage(queue, true);
+}
+
+void leaveSharedStorage(PriorityQueue queue)
+{
+    if (!isStorageShared(queue))
+    {
+        return;
+    }
+
+    if (queue->owns_storage)
+    {
+        queue->shared_next->owns_storage = true;
+        queue->owns_storage = false;
+    }
+
+    unlinkFromRing(queue);
+}
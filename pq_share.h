@@ -0,0 +1,62 @@
+#ifndef PQ_SHARE_H
+#define PQ_SHARE_H
+
+#include <stdbool.h>
+#include "priority_queue.h"
+#include "pq_helper.h"
+
+/**
+*   Copy on write storage.
+*   A copy of a queue shares the storage (nodes, node pool, heap array and hash index) of the queue
+*   it was copied from, until one of them changes. The queues that share a storage are linked in a ring,
+*   and one of them owns the storage. Before a change, a queue that does not own the storage copies it
+*   for itself, and an owner lets the other queues of the ring move to one copy of it, so the nodes of
+*   an owner (and its handles) never move.
+*   A queue that does not own the storage also copies it before it gives out one of its elements, so
+*   the elements it gives out stay valid until it changes itself, whatever the owner does.
+*/
+
+/**
+*   isStorageShared: Returns whether the storage of the queue is shared with other queues.
+*/
+bool isStorageShared(PriorityQueue queue);
+
+/**
+*   shareStorage: Makes new_queue share the storage of queue. new_queue must be a new queue
+*   created with the options of queue, and its own (empty) storage is destroyed.
+*
+* @param queue - The queue to share the storage of.
+* @param new_queue - The queue to share the storage with.
+*/
+void shareStorage(PriorityQueue queue, PriorityQueue new_queue);
+
+/**
+*   unshareStorage: Makes sure that the storage of the queue is not shared, before a change of the queue.
+*   If it is shared, either the queue or the other queues of its ring get a copy of the storage.
+*
+* @param queue - The queue that is about to change.
+* @param keep_entries - false if the queue is about to be cleared, so it gets an empty storage instead of a copy.
+* @return
+* 	PQ_OUT_OF_MEMORY if the copy could not be allocated. No queue is changed in that case.
+* 	PQ_SUCCESS otherwise.
+*/
+PriorityQueueResult unshareStorage(PriorityQueue queue, bool keep_entries);
+
+/**
+*   unshareStorageForRead: Makes sure that the elements the queue gives out are its own, before
+*   pqGetFirst or pqIterBegin. A queue that shares the storage it does not own gets a copy of it.
+*
+* @return
+* 	PQ_OUT_OF_MEMORY if the copy could not be allocated. No queue is changed in that case.
+* 	PQ_SUCCESS otherwise.
+*/
+PriorityQueueResult unshareStorageForRead(PriorityQueue queue);
+
+/**
+*   leaveSharedStorage: Removes the queue from the ring of its shared storage, before it is destroyed.
+*   If the queue owns the storage, another queue of the ring becomes the owner.
+*   The storage is left to the other queues, so it must not be freed by the queue.
+*/
+void leaveSharedStorage(PriorityQueue queue);
+
+#endif /* PQ_SHARE_H */
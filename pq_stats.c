@@ -0,0 +1,36 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <time.h>
+#include "priority_queue.h"
+#include "pq_helper.h"
+#include "pq_stats.h"
+
+#ifdef PQ_ENABLE_STATS
+
+unsigned long statsGetTime(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long)now.tv_sec * 1000000000UL + (unsigned long)now.tv_nsec;
+}
+
+void statsRecordLatency(PriorityQueue queue, PQStatsOperation operation, unsigned long start)
+{
+    if (queue == NULL)
+    {
+        return;
+    }
+
+    // the bucket of a latency is the index of its highest bit
+    unsigned long latency = statsGetTime() - start;
+    int bucket = 0;
+    while (latency > 1 && bucket < PQ_STATS_LATENCY_BUCKETS - 1)
+    {
+        latency >>= 1;
+        bucket++;
+    }
+
+    queue->stats.latency_histogram[operation][bucket]++;
+}
+
+#endif /* PQ_ENABLE_STATS */
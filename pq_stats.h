@@ -0,0 +1,45 @@
+#ifndef PQ_STATS_H
+#define PQ_STATS_H
+
+#include "priority_queue.h"
+
+/**
+*   Operation counters of the priority queue, compiled in only when PQ_ENABLE_STATS is defined.
+*   Without it every macro here expands to nothing (or to the plain callback call), so the counters
+*   cost nothing in a release build.
+*   The callback macros call a function of the queue and count the call.
+*/
+
+#ifdef PQ_ENABLE_STATS
+
+#define PQ_STATS_COUNT(queue, counter) ((queue)->stats.counter++)
+#define PQ_STATS_UPDATE_MAX_SIZE(queue) \
+    ((queue)->stats.max_size = (queue)->size > (queue)->stats.max_size ? (queue)->size : (queue)->stats.max_size)
+#define PQ_STATS_TIMER_START(start) unsigned long start = statsGetTime()
+#define PQ_STATS_TIMER_STOP(queue, operation, start) statsRecordLatency(queue, operation, start)
+
+/** Returns a monotonic time in nanoseconds */
+unsigned long statsGetTime(void);
+
+/** Adds the time since start to the latency histogram of operation. Does nothing if queue is NULL */
+void statsRecordLatency(PriorityQueue queue, PQStatsOperation operation, unsigned long start);
+
+#else
+
+#define PQ_STATS_COUNT(queue, counter) ((void)0)
+#define PQ_STATS_UPDATE_MAX_SIZE(queue) ((void)0)
+#define PQ_STATS_TIMER_START(start)
+#define PQ_STATS_TIMER_STOP(queue, operation, start)
+
+#endif /* PQ_ENABLE_STATS */
+
+#define COMPARE_PRIORITIES(queue, first, second) \
+    (PQ_STATS_COUNT(queue, comparisons), (queue)->compare_priorities(first, second))
+#define EQUAL_ELEMENTS(queue, first, second) \
+    (PQ_STATS_COUNT(queue, equality_checks), (queue)->equal_elements(first, second))
+#define COPY_ELEMENT(queue, element) (PQ_STATS_COUNT(queue, copies), (queue)->copy_element(element))
+#define COPY_PRIORITY(queue, priority) (PQ_STATS_COUNT(queue, copies), (queue)->copy_priority(priority))
+#define FREE_ELEMENT(queue, element) (PQ_STATS_COUNT(queue, frees), (queue)->free_element(element))
+#define FREE_PRIORITY(queue, priority) (PQ_STATS_COUNT(queue, frees), (queue)->free_priority(priority))
+
+#endif /* PQ_STATS_H */
@@ -0,0 +1,297 @@
+#ifndef PQ_TYPED_H
+#define PQ_TYPED_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include "priority_queue.h"
+
+/**
+* Typed Priority Queue Generator
+*
+* PQ_DEFINE(name, ElementType, PriorityType, compare_priorities, equal_elements) defines a priority queue
+* type called name, that keeps its elements and priorities by value in an array based binary heap.
+* compare_priorities(PriorityType, PriorityType) and equal_elements(ElementType, ElementType) work like
+* the functions given to pqCreate, but take the values themselves. They may be macros or static inline
+* functions, and are called directly, so the compiler can inline them into the heap operations.
+* Like the priority queue, the highest priority comes first, and between equal priorities the
+* element that was inserted first comes first.
+* Elements and priorities are copied by assignment, so they must not own memory that the queue would
+* have to free.
+*
+* The following functions are defined, all static inline, where name is the given name:
+*   nameCreate          - Creates a new empty queue
+*   nameDestroy         - Deletes an existing queue and frees all resources
+*   nameCopy            - Copies an existing queue
+*   nameGetSize         - Returns the size of a given queue
+*   nameContains        - Returns whether or not an element exists inside the queue.
+*   nameInsert          - Insert an element with a given priority to the queue.
+*   nameChangePriority  - Changes the priority of an element with specific priority
+*   nameRemove          - Removes the highest priority element in the queue
+*   nameRemoveElement   - Removes the highest priority element that is equal to a given element
+*   namePop             - Removes the highest priority element and gives it to the caller.
+*   nameGetFirst        - Returns the highest priority element in the queue.
+*   nameClear           - Clears the contents of the queue.
+* The functions have the same arguments and results as their pq counterparts, with values instead
+* of pointers to elements and priorities. namePop returns PQ_SUCCESS or PQ_ELEMENT_DOES_NOT_EXISTS,
+* and stores the element and its priority (if the pointer is not NULL) for the caller.
+* There is no iteration in queue order, since the heap keeps only the first element in place.
+*/
+
+#define PQ_TYPED_MIN_CAPACITY 16
+
+#define PQ_DEFINE(name, ElementType, PriorityType, compare_priorities, equal_elements) \
+ \
+typedef struct name##Entry_t \
+{ \
+    ElementType element; \
+    PriorityType priority; \
+    unsigned long sequence; \
+} name##Entry; \
+ \
+typedef struct name##_t \
+{ \
+    name##Entry* entries; \
+    int size; \
+    int capacity; \
+    unsigned long next_sequence; \
+} *name; \
+ \
+static inline bool name##IsBefore(const name##Entry* first, const name##Entry* second) \
+{ \
+    int result = compare_priorities(first->priority, second->priority); \
+    return result > 0 || (result == 0 && first->sequence < second->sequence); \
+} \
+ \
+static inline void name##SiftUp(name queue, int index) \
+{ \
+    name##Entry entry = queue->entries[index]; \
+    while (index > 0 && name##IsBefore(&entry, &queue->entries[(index - 1) / 2])) \
+    { \
+        queue->entries[index] = queue->entries[(index - 1) / 2]; \
+        index = (index - 1) / 2; \
+    } \
+    queue->entries[index] = entry; \
+} \
+ \
+static inline void name##SiftDown(name queue, int index) \
+{ \
+    name##Entry entry = queue->entries[index]; \
+    for (int child = 2 * index + 1; child < queue->size; child = 2 * index + 1) \
+    { \
+        if (child + 1 < queue->size && name##IsBefore(&queue->entries[child + 1], &queue->entries[child])) \
+        { \
+            child++; \
+        } \
+        if (!name##IsBefore(&queue->entries[child], &entry)) \
+        { \
+            break; \
+        } \
+        queue->entries[index] = queue->entries[child]; \
+        index = child; \
+    } \
+    queue->entries[index] = entry; \
+} \
+ \
+static inline void name##RemoveAt(name queue, int index) \
+{ \
+    queue->size--; \
+    if (index == queue->size) \
+    { \
+        return; \
+    } \
+    queue->entries[index] = queue->entries[queue->size]; \
+    name##SiftUp(queue, index); \
+    name##SiftDown(queue, index); \
+} \
+ \
+/** Returns the index of the first entry in queue order with element (and priority, if given), or -1 */ \
+static inline int name##FindEntry(name queue, ElementType element, const PriorityType* priority) \
+{ \
+    int found_index = -1; \
+    for (int i = 0; i < queue->size; i++) \
+    { \
+        if (equal_elements(queue->entries[i].element, element) && \
+            (priority == NULL || compare_priorities(queue->entries[i].priority, *priority) == 0) && \
+            (found_index == -1 || name##IsBefore(&queue->entries[i], &queue->entries[found_index]))) \
+        { \
+            found_index = i; \
+        } \
+    } \
+    return found_index; \
+} \
+ \
+static inline name name##Create(void) \
+{ \
+    name queue = (name)malloc(sizeof(struct name##_t)); \
+    if (queue == NULL) \
+    { \
+        return NULL; \
+    } \
+    queue->entries = NULL; \
+    queue->size = 0; \
+    queue->capacity = 0; \
+    queue->next_sequence = 0; \
+    return queue; \
+} \
+ \
+static inline void name##Destroy(name queue) \
+{ \
+    if (queue == NULL) \
+    { \
+        return; \
+    } \
+    free(queue->entries); \
+    free(queue); \
+} \
+ \
+static inline name name##Copy(name queue) \
+{ \
+    if (queue == NULL) \
+    { \
+        return NULL; \
+    } \
+    name new_queue = name##Create(); \
+    if (new_queue == NULL) \
+    { \
+        return NULL; \
+    } \
+    if (queue->size > 0) \
+    { \
+        new_queue->entries = (name##Entry*)malloc(queue->size * sizeof(name##Entry)); \
+        if (new_queue->entries == NULL) \
+        { \
+            free(new_queue); \
+            return NULL; \
+        } \
+        for (int i = 0; i < queue->size; i++) \
+        { \
+            new_queue->entries[i] = queue->entries[i]; \
+        } \
+    } \
+    new_queue->size = queue->size; \
+    new_queue->capacity = queue->size; \
+    new_queue->next_sequence = queue->next_sequence; \
+    return new_queue; \
+} \
+ \
+static inline int name##GetSize(name queue) \
+{ \
+    return queue == NULL ? -1 : queue->size; \
+} \
+ \
+static inline bool name##Contains(name queue, ElementType element) \
+{ \
+    return queue != NULL && name##FindEntry(queue, element, NULL) != -1; \
+} \
+ \
+static inline PriorityQueueResult name##Insert(name queue, ElementType element, PriorityType priority) \
+{ \
+    if (queue == NULL) \
+    { \
+        return PQ_NULL_ARGUMENT; \
+    } \
+    if (queue->size == queue->capacity) \
+    { \
+        int new_capacity = queue->capacity < PQ_TYPED_MIN_CAPACITY ? PQ_TYPED_MIN_CAPACITY : 2 * queue->capacity; \
+        name##Entry* new_entries = (name##Entry*)realloc(queue->entries, new_capacity * sizeof(name##Entry)); \
+        if (new_entries == NULL) \
+        { \
+            return PQ_OUT_OF_MEMORY; \
+        } \
+        queue->entries = new_entries; \
+        queue->capacity = new_capacity; \
+    } \
+    name##Entry* entry = &queue->entries[queue->size]; \
+    entry->element = element; \
+    entry->priority = priority; \
+    entry->sequence = queue->next_sequence++; \
+    queue->size++; \
+    name##SiftUp(queue, queue->size - 1); \
+    return PQ_SUCCESS; \
+} \
+ \
+static inline PriorityQueueResult name##ChangePriority(name queue, ElementType element, PriorityType old_priority, \
+                                                       PriorityType new_priority) \
+{ \
+    if (queue == NULL) \
+    { \
+        return PQ_NULL_ARGUMENT; \
+    } \
+    int index = name##FindEntry(queue, element, &old_priority); \
+    if (index == -1) \
+    { \
+        return PQ_ELEMENT_DOES_NOT_EXISTS; \
+    } \
+    /* the element is considered as reinserted, like in pqChangePriority */ \
+    queue->entries[index].priority = new_priority; \
+    queue->entries[index].sequence = queue->next_sequence++; \
+    name##SiftUp(queue, index); \
+    name##SiftDown(queue, index); \
+    return PQ_SUCCESS; \
+} \
+ \
+static inline PriorityQueueResult name##Remove(name queue) \
+{ \
+    if (queue == NULL) \
+    { \
+        return PQ_NULL_ARGUMENT; \
+    } \
+    if (queue->size == 0) \
+    { \
+        /* an empty queue gives the same result as in pqRemove */ \
+        return PQ_NULL_ARGUMENT; \
+    } \
+    name##RemoveAt(queue, 0); \
+    return PQ_SUCCESS; \
+} \
+ \
+static inline PriorityQueueResult name##RemoveElement(name queue, ElementType element) \
+{ \
+    if (queue == NULL) \
+    { \
+        return PQ_NULL_ARGUMENT; \
+    } \
+    int index = name##FindEntry(queue, element, NULL); \
+    if (index == -1) \
+    { \
+        return PQ_ELEMENT_DOES_NOT_EXISTS; \
+    } \
+    name##RemoveAt(queue, index); \
+    return PQ_SUCCESS; \
+} \
+ \
+static inline PriorityQueueResult name##Pop(name queue, ElementType* element, PriorityType* priority) \
+{ \
+    if (queue == NULL || element == NULL) \
+    { \
+        return PQ_NULL_ARGUMENT; \
+    } \
+    if (queue->size == 0) \
+    { \
+        return PQ_ELEMENT_DOES_NOT_EXISTS; \
+    } \
+    *element = queue->entries[0].element; \
+    if (priority != NULL) \
+    { \
+        *priority = queue->entries[0].priority; \
+    } \
+    name##RemoveAt(queue, 0); \
+    return PQ_SUCCESS; \
+} \
+ \
+static inline ElementType* name##GetFirst(name queue) \
+{ \
+    return queue == NULL || queue->size == 0 ? NULL : &queue->entries[0].element; \
+} \
+ \
+static inline PriorityQueueResult name##Clear(name queue) \
+{ \
+    if (queue == NULL) \
+    { \
+        return PQ_NULL_ARGUMENT; \
+    } \
+    queue->size = 0; \
+    return PQ_SUCCESS; \
+}
+
+#endif /* PQ_TYPED_H */
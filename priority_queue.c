@@ -2,6 +2,12 @@
 #include <assert.h>
 #include "priority_queue.h"
 #include "pq_helper.h"
+#include "pq_stats.h"
+#include "pq_heap.h"
+#include "pq_hash.h"
+#include "pq_pool.h"
+#include "pq_share.h"
+#include "pq_pairing.h"
 
 #define NULL_INPUT_ERROR -1
 #define EQUALS_PRIORITY 0
@@ -13,6 +19,18 @@ PriorityQueue pqCreate(CopyPQElement copy_element,
                        FreePQElementPriority free_priority,
                        ComparePQElementPriorities compare_priorities)
 {
+    return pqCreateWithOptions(copy_element, free_element, equal_elements,
+                               copy_priority, free_priority, compare_priorities, NULL);
+}
+
+PriorityQueue pqCreateWithOptions(CopyPQElement copy_element,
+                                  FreePQElement free_element,
+                                  EqualPQElements equal_elements,
+                                  CopyPQElementPriority copy_priority,
+                                  FreePQElementPriority free_priority,
+                                  ComparePQElementPriorities compare_priorities,
+                                  const PQOptions* options)
+{
 
     // check if the inputs are null
     if (!copy_element || !free_element || !equal_elements || !copy_priority || !free_priority || !compare_priorities)
@@ -20,6 +38,25 @@ PriorityQueue pqCreate(CopyPQElement copy_element,
         return NULL;
     }
 
+    PQOptions default_options = {0};
+    if (options == NULL)
+    {
+        options = &default_options;
+    }
+
+    // check if the options are legal
+    if ((options->engine != PQ_ENGINE_SORTED_LIST && options->engine != PQ_ENGINE_HEAP &&
+         options->engine != PQ_ENGINE_PAIRING) || 
+        options->heap_arity < 0 || options->heap_arity == 1 || options->initial_capacity < 0 ||
+        options->capacity < 0 || options->element_size < 0 || options->priority_size < 0 ||
+        options->max_removed_percent < 0 || options->max_removed_percent > 100 ||
+        (options->overflow_policy != PQ_OVERFLOW_EVICT && options->overflow_policy != PQ_OVERFLOW_REJECT) ||
+        (options->capacity > 0 && options->overflow_policy == PQ_OVERFLOW_EVICT &&
+         options->engine == PQ_ENGINE_PAIRING))
+    {
+        return NULL;
+    }
+
     PriorityQueue new_priority_queue = (PriorityQueue)malloc(sizeof(struct PriorityQueue_t));
     if (new_priority_queue == NULL)
     {
@@ -27,14 +64,54 @@ PriorityQueue pqCreate(CopyPQElement copy_element,
     }
 
     new_priority_queue->copy_element = copy_element;
-    new_priority_queue->free_element = free_priority;
+    new_priority_queue->free_element = free_element;
     new_priority_queue->equal_elements = equal_elements;
     new_priority_queue->copy_priority = copy_priority;
     new_priority_queue->free_priority = free_priority;
     new_priority_queue->compare_priorities = compare_priorities;
+    new_priority_queue->hash_element = options->hash_element;
+    new_priority_queue->evict_element = options->evict_element;
+    new_priority_queue->capacity = options->capacity;
+    new_priority_queue->overflow_policy = options->overflow_policy;
+    new_priority_queue->buckets = NULL;
+    new_priority_queue->bucket_count = 0;
+    new_priority_queue->engine = options->engine;
+    new_priority_queue->heap_arity = options->heap_arity == 0 ? DEFAULT_HEAP_ARITY : options->heap_arity;
+    new_priority_queue->heap = NULL;
+    new_priority_queue->last_heap = NULL;
+    new_priority_queue->heap_size = 0;
+    new_priority_queue->heap_capacity = 0;
+    new_priority_queue->pairing_root = NULL;
+    new_priority_queue->free_nodes = NULL;
+    new_priority_queue->last_free_node = NULL;
+    new_priority_queue->free_node_count = 0;
+    new_priority_queue->slabs = NULL;
+    new_priority_queue->last_slab = NULL;
+    new_priority_queue->pool_capacity = 0;
+    setInlineSizes(new_priority_queue, options->element_size, options->priority_size);
     new_priority_queue->element_list = NULL;
+    new_priority_queue->last_element = NULL;
+    new_priority_queue->is_element_list_valid = true;
+    new_priority_queue->size = 0;
+    new_priority_queue->removed_count = 0;
+    new_priority_queue->max_removed_percent = options->max_removed_percent;
+    new_priority_queue->version = 0;
     new_priority_queue->iterator = NULL;
     new_priority_queue->is_iterator_undefined=false;
+    new_priority_queue->shared_prev = new_priority_queue;
+    new_priority_queue->shared_next = new_priority_queue;
+    new_priority_queue->owns_storage = true;
+#ifdef PQ_ENABLE_STATS
+    new_priority_queue->stats = (PQStats){0};
+#endif
+
+    if ((options->hash_element != NULL && hashCreateIndex(new_priority_queue) != PQ_SUCCESS) ||
+        poolReserve(new_priority_queue, options->initial_capacity) != PQ_SUCCESS ||
+        (options->engine == PQ_ENGINE_HEAP && heapReserve(new_priority_queue, options->initial_capacity) != PQ_SUCCESS))
+    {
+        pqDestroy(new_priority_queue);
+        return NULL;
+    }
 
     return new_priority_queue;
 
@@ -47,19 +124,18 @@ void pqDestroy(PriorityQueue queue)
         return;
     }
 
-    if(queue->element_list == NULL)
+    if (isStorageShared(queue))
     {
+        leaveSharedStorage(queue);
         free(queue);
         return;
     }
 
-    while(queue->element_list->next != NULL)
-    {  
-        removeElementNode(queue, queue->element_list);
-    }
-    // free last element node
-    freeElementNode(queue, queue->element_list);
+    pqClear(queue);
 
+    hashDestroyIndex(queue);
+    poolDestroy(queue);
+    heapDestroy(queue);
     free(queue);
 }
 
@@ -70,15 +146,22 @@ PriorityQueue pqCopy(PriorityQueue queue)
         return NULL;
     }
 
-    PriorityQueue new_priority_queue = pqCreate(queue->copy_element, queue->free_element, queue->equal_elements, 
-                                  queue->copy_priority, queue->free_priority, queue->compare_priorities);
+    PQOptions options = {.engine = queue->engine, .heap_arity = queue->heap_arity, 
+                         .hash_element = queue->hash_element, .capacity = queue->capacity,
+                         .overflow_policy = queue->overflow_policy, .evict_element = queue->evict_element,
+                         .element_size = queue->element_size, .priority_size = queue->priority_size,
+                         .max_removed_percent = queue->max_removed_percent};
+    PriorityQueue new_priority_queue = pqCreateWithOptions(queue->copy_element, queue->free_element, 
+                                                           queue->equal_elements, queue->copy_priority, 
+                                                           queue->free_priority, queue->compare_priorities, &options);
     if(new_priority_queue == NULL)
     {
         return NULL;
     }
 
-    new_priority_queue->element_list = copyElementList(queue);
-    
+    // the entries are copied only when one of the queues changes
+    shareStorage(queue, new_priority_queue);
+
     new_priority_queue->is_iterator_undefined = true;
     queue->is_iterator_undefined = true;
 
@@ -92,88 +175,272 @@ int pqGetSize(PriorityQueue queue)
         return NULL_INPUT_ERROR;
     }
 
-    int elements_size = 0;
+    return queue->size - queue->removed_count;
+}
 
-    ElementNode current_element = queue->element_list;
+bool pqContains(PriorityQueue queue, PQElement element)
+{
+    if (queue == NULL || element == NULL)
+    {
+        return false;
+    }
 
-    while(current_element != NULL){
-        elements_size++;
-        current_element = current_element->next;
+    if (queue->buckets != NULL)
+    {
+        return hashContains(queue, element);
     }
 
-    return elements_size;
+    return findElementNode(queue, element, NULL) != NULL;
 }
 
-bool pqContains(PriorityQueue queue, PQElement element)
+PriorityQueueResult pqInsert(PriorityQueue queue, PQElement element, PQElementPriority priority)
 {
-    if (queue == NULL || element == NULL)
+    PQHandle handle;
+    return pqInsertWithHandle(queue, element, priority, &handle);
+}
+
+static PriorityQueueResult insertEntry(PriorityQueue queue, PQElement element, PQElementPriority priority,
+                                       PQHandle* handle)
+{
+    if (queue == NULL || element == NULL || priority == NULL || handle == NULL)
     {
-        return false;
+        return PQ_NULL_ARGUMENT;
     }
 
-    ElementNode current_element = queue->element_list;
+    queue->is_iterator_undefined = true;
+    if (unshareStorage(queue, true) != PQ_SUCCESS)
+    {
+        return PQ_OUT_OF_MEMORY;
+    }
 
-    while(current_element != NULL){
+    bool is_evicted = false;
+    PriorityQueueResult room_result = makeRoomForEntry(queue, element, priority, &is_evicted);
+    if (room_result != PQ_SUCCESS || is_evicted)
+    {
+        *handle = NULL;
+        return room_result;
+    }
 
-        if(queue->equal_elements(current_element->element_data, element))
-        {
-            return true;
-        }
+    ElementNode new_element = createNewElementNode(queue, element, priority);
+    if (new_element == NULL)
+    {
+        return PQ_OUT_OF_MEMORY;
+    }
 
-        current_element = current_element->next;
+    if (linkElementNode(queue, new_element) != PQ_SUCCESS)
+    {
+        freeElementNode(queue, new_element);
+        return PQ_OUT_OF_MEMORY;
     }
 
-    return false;
+    *handle = new_element;
+    return PQ_SUCCESS;
 }
 
-PriorityQueueResult pqInsert(PriorityQueue queue, PQElement element, PQElementPriority priority)
+PriorityQueueResult pqInsertWithHandle(PriorityQueue queue, PQElement element, PQElementPriority priority,
+                                       PQHandle* handle)
+{
+    PQ_STATS_TIMER_START(start);
+    PriorityQueueResult result = insertEntry(queue, element, priority, handle);
+    PQ_STATS_TIMER_STOP(queue, PQ_STATS_INSERT, start);
+    return result;
+}
+
+PriorityQueueResult pqInsertTake(PriorityQueue queue, PQElement element, PQElementPriority priority)
 {
     if (queue == NULL || element == NULL || priority == NULL)
     {
         return PQ_NULL_ARGUMENT;
     }
 
-    ElementNode new_element = createNewElementNode(queue, element, priority);
+    queue->is_iterator_undefined = true;
+    if (unshareStorage(queue, true) != PQ_SUCCESS)
+    {
+        return PQ_OUT_OF_MEMORY;
+    }
+
+    bool is_evicted = false;
+    PriorityQueueResult room_result = makeRoomForEntry(queue, element, priority, &is_evicted);
+    if (room_result != PQ_SUCCESS)
+    {
+        return room_result;
+    }
+
+    if (is_evicted)
+    {
+        // the queue took the ownership of the evicted entry
+        FREE_ELEMENT(queue, element);
+        FREE_PRIORITY(queue, priority);
+        return PQ_SUCCESS;
+    }
+
+    ElementNode new_element = adoptNewElementNode(queue, element, priority);
     if (new_element == NULL)
     {
         return PQ_OUT_OF_MEMORY;
     }
 
+    if (linkElementNode(queue, new_element) != PQ_SUCCESS)
+    {
+        // the caller keeps the ownership on failure
+        poolFreeNode(queue, new_element);
+        return PQ_OUT_OF_MEMORY;
+    }
+
+    releaseAdoptedData(queue, element, priority);
+    return PQ_SUCCESS;
+}
+
+PriorityQueueResult pqInsertBatch(PriorityQueue queue, PQElement* elements, PQElementPriority* priorities, 
+                                  int count)
+{
+    if (queue == NULL || elements == NULL || priorities == NULL)
+    {
+        return PQ_NULL_ARGUMENT;
+    }
+
+    if (count < 0)
+    {
+        return PQ_ERROR;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        if (elements[i] == NULL || priorities[i] == NULL)
+        {
+            return PQ_NULL_ARGUMENT;
+        }
+    }
+
+    if (queue->capacity > 0 && queue->overflow_policy == PQ_OVERFLOW_REJECT &&
+        pqGetSize(queue) + count > queue->capacity)
+    {
+        return PQ_QUEUE_FULL;
+    }
+
+    if (unshareStorage(queue, true) != PQ_SUCCESS || poolReserve(queue, count) != PQ_SUCCESS)
+    {
+        return PQ_OUT_OF_MEMORY;
+    }
+
+    // create all the nodes first, so nothing is inserted if an allocation fails
+    struct element_t new_list_head;
+    ElementNode new_list_tail = &new_list_head;
+    int created_count = 0;
+    while (created_count < count)
+    {
+        new_list_tail->next = createNewElementNode(queue, elements[created_count], priorities[created_count]);
+        if (new_list_tail->next == NULL)
+        {
+            break;
+        }
+        new_list_tail = new_list_tail->next;
+        created_count++;
+    }
+    new_list_tail->next = NULL;
+
+    if (created_count < count || linkElementNodes(queue, new_list_head.next, count) != PQ_SUCCESS)
+    {
+        while (new_list_head.next != NULL)
+        {
+            ElementNode next_element = new_list_head.next->next;
+            freeElementNode(queue, new_list_head.next);
+            new_list_head.next = next_element;
+        }
+        return PQ_OUT_OF_MEMORY;
+    }
+
+    evictOverflowElementNodes(queue);
+    assert(isSizeConsistent(queue));
+
     queue->is_iterator_undefined = true;
+    return PQ_SUCCESS;
+}
 
-    ElementNode current_element = queue->element_list;
-    
-    // check if need to be in the first place - the highest priority
-    if(current_element == NULL || 
-       queue->compare_priorities(current_element->element_priority,new_element->element_priority) < EQUALS_PRIORITY)
+PriorityQueueResult pqMerge(PriorityQueue destination, PriorityQueue source)
+{
+    if (destination == NULL || source == NULL)
     {
-        new_element->next = current_element;
-        queue->element_list = new_element;
-        return PQ_SUCCESS;
+        return PQ_NULL_ARGUMENT;
     }
 
-    // put the element in the right place in list
-    while (current_element->next != NULL)
-    {   
-        if(queue->compare_priorities(current_element->next->element_priority,
-                                     new_element->element_priority) < EQUALS_PRIORITY)
+    // destination frees and orders the entries of source from now on
+    if (destination == source ||
+        destination->copy_element != source->copy_element || destination->free_element != source->free_element ||
+        destination->equal_elements != source->equal_elements ||
+        destination->copy_priority != source->copy_priority || destination->free_priority != source->free_priority ||
+        destination->compare_priorities != source->compare_priorities ||
+        destination->element_size != source->element_size || destination->priority_size != source->priority_size)
+    {
+        return PQ_ERROR;
+    }
+
+    if (destination->capacity > 0 && destination->overflow_policy == PQ_OVERFLOW_REJECT &&
+        pqGetSize(destination) + pqGetSize(source) > destination->capacity)
+    {
+        return PQ_QUEUE_FULL;
+    }
+
+    // make sure nothing can fail once the nodes are moved
+    if (unshareStorage(destination, true) != PQ_SUCCESS || unshareStorage(source, true) != PQ_SUCCESS ||
+        (destination->engine == PQ_ENGINE_HEAP &&
+         heapReserve(destination, destination->heap_size + source->size) != PQ_SUCCESS))
+    {
+        return PQ_OUT_OF_MEMORY;
+    }
+
+    destination->is_iterator_undefined = true;
+    source->is_iterator_undefined = true;
+
+    // the removed entries of source are not moved
+    compactElementNodes(source);
+
+    // two pairing heaps are melded as they are, without ordering the nodes of source
+    bool is_meld = destination->engine == PQ_ENGINE_PAIRING && source->engine == PQ_ENGINE_PAIRING;
+    int count = source->size;
+    ElementNode list = NULL;
+    ElementNode root = source->pairing_root;
+    if (!is_meld)
+    {
+        list = getElementList(source);
+        for (ElementNode node = list; node != NULL; node = node->next)
         {
-            new_element->next = current_element->next;
-            current_element->next = new_element;
-            return PQ_SUCCESS;
+            node->hash_value = destination->hash_element != NULL ? destination->hash_element(node->element_data) : 0;
         }
+    }
+
+    // empty source without freeing its nodes
+    source->pairing_root = NULL;
+    source->element_list = NULL;
+    source->last_element = NULL;
+    source->is_element_list_valid = true;
+    source->heap_size = 0;
+    source->size = 0;
+    source->version++;
+    if (source->buckets != NULL)
+    {
+        hashClearIndex(source);
+    }
+    poolMoveNodes(destination, source);
 
-        current_element = current_element->next;
+    if (is_meld)
+    {
+        meldElementTree(destination, root, count);
+    }
+    else
+    {
+        // the heap array was reserved above, so linking does not fail
+        linkElementNodes(destination, list, count);
     }
 
-    // last element in the list
-    new_element->next = NULL;
-    current_element->next = new_element;
+    evictOverflowElementNodes(destination);
+    assert(isSizeConsistent(destination) && isSizeConsistent(source));
+
     return PQ_SUCCESS;
 }
 
-PriorityQueueResult pqChangePriority(PriorityQueue queue, PQElement element, 
-                                     PQElementPriority old_priority, PQElementPriority new_priority)
+static PriorityQueueResult changeEntryPriority(PriorityQueue queue, PQElement element, 
+                                               PQElementPriority old_priority, PQElementPriority new_priority)
 {
     if (queue == NULL || element == NULL || old_priority == NULL || new_priority == NULL)
     {
@@ -181,91 +448,309 @@ PriorityQueueResult pqChangePriority(PriorityQueue queue, PQElement element,
     }
 
     queue->is_iterator_undefined = true;
+    if (unshareStorage(queue, true) != PQ_SUCCESS)
+    {
+        return PQ_OUT_OF_MEMORY;
+    }
 
-    if(queue->element_list == NULL)
+    ElementNode element_to_change = findElementNode(queue, element, old_priority);
+    if (element_to_change == NULL)
     {
         return PQ_ELEMENT_DOES_NOT_EXISTS;
     }
 
-    ElementNode current_element = queue->element_list;
+    // the element keeps its node, only the priority is replaced
+    return replaceElementNodePriority(queue, element_to_change, new_priority);
+}
 
-    // check if the first element is the one that need to change
-    if(queue->equal_elements(current_element->element_data, element) &&
-        queue->compare_priorities(current_element->element_priority, old_priority) == EQUALS_PRIORITY)
+PriorityQueueResult pqChangePriority(PriorityQueue queue, PQElement element, 
+                                     PQElementPriority old_priority, PQElementPriority new_priority)
+{
+    PQ_STATS_TIMER_START(start);
+    PriorityQueueResult result = changeEntryPriority(queue, element, old_priority, new_priority);
+    PQ_STATS_TIMER_STOP(queue, PQ_STATS_CHANGE_PRIORITY, start);
+    return result;
+}
+
+PriorityQueueResult pqChangePriorityBatch(PriorityQueue queue, PQElement* elements, PQElementPriority* old_priorities,
+                                          PQElementPriority* new_priorities, int count)
+{
+    if (queue == NULL || elements == NULL || old_priorities == NULL || new_priorities == NULL)
     {
-        pqRemove(queue);
-        return pqInsert(queue, element, new_priority);
+        return PQ_NULL_ARGUMENT;
     }
 
-    // remove the element with the old priority and pqInsert with new_priority
-    while(current_element->next != NULL){
+    if (count < 0)
+    {
+        return PQ_ERROR;
+    }
 
-        if(queue->equal_elements(current_element->next->element_data, element) &&
-            queue->compare_priorities(current_element->next->element_priority, old_priority) == EQUALS_PRIORITY)
+    for (int i = 0; i < count; i++)
+    {
+        if (elements[i] == NULL || old_priorities[i] == NULL || new_priorities[i] == NULL)
         {
-            removeElementNode(queue, current_element);
-            return pqInsert(queue, element, new_priority);    
+            return PQ_NULL_ARGUMENT;
         }
+    }
 
-        current_element = current_element->next;
+    queue->is_iterator_undefined = true;
+    if (unshareStorage(queue, true) != PQ_SUCCESS)
+    {
+        return PQ_OUT_OF_MEMORY;
     }
 
-    return PQ_ELEMENT_DOES_NOT_EXISTS;
+    // without a hash index all the nodes are found in one walk over the queue, before any of them changes
+    ElementNode* found_nodes = NULL;
+    if (queue->buckets == NULL)
+    {
+        found_nodes = (ElementNode*)malloc(count * sizeof(ElementNode));
+        if (found_nodes == NULL && count > 0)
+        {
+            return PQ_OUT_OF_MEMORY;
+        }
+
+        PriorityQueueResult find_result = findElementNodes(queue, elements, old_priorities, count, found_nodes);
+        if (find_result != PQ_SUCCESS)
+        {
+            free(found_nodes);
+            return find_result;
+        }
+    }
+
+    // with a hash index the nodes are unlinked as they are found, so the next change of the same element
+    // finds another node
+    struct element_t changed_list_head;
+    ElementNode changed_list_tail = &changed_list_head;
+    int found_count = 0;
+    while (found_count < count)
+    {
+        ElementNode node = found_nodes != NULL ? found_nodes[found_count] :
+                           findElementNode(queue, elements[found_count], old_priorities[found_count]);
+        if (node == NULL)
+        {
+            break;
+        }
+        unlinkElementNode(queue, node);
+        changed_list_tail->next = node;
+        changed_list_tail = node;
+        found_count++;
+    }
+    changed_list_tail->next = NULL;
+    free(found_nodes);
+
+    PriorityQueueResult result = PQ_ELEMENT_DOES_NOT_EXISTS;
+    if (found_count == count)
+    {
+        result = replaceElementNodePriorities(queue, changed_list_head.next, new_priorities, count);
+    }
+
+    // the nodes go back to the room they were unlinked from, so linking them does not fail,
+    // and on failure they are relinked with their old priorities and sequences
+    linkElementNodes(queue, changed_list_head.next, found_count);
+    freeFirstRemovedNodes(queue);
+
+    return result;
 }
 
-PriorityQueueResult pqRemove(PriorityQueue queue)
+PriorityQueueResult pqUpdatePriorityByHandle(PriorityQueue queue, PQHandle handle, PQElementPriority new_priority)
 {
-    if (queue == NULL)
+    if (queue == NULL || handle == NULL || new_priority == NULL)
+    {
+        return PQ_NULL_ARGUMENT;
+    }
+
+    queue->is_iterator_undefined = true;
+    if (unshareStorage(queue, true) != PQ_SUCCESS)
+    {
+        return PQ_OUT_OF_MEMORY;
+    }
+
+    return replaceElementNodePriority(queue, handle, new_priority);
+}
+
+PriorityQueueResult pqRemoveByHandle(PriorityQueue queue, PQHandle handle)
+{
+    if (queue == NULL || handle == NULL)
     {
         return PQ_NULL_ARGUMENT;
     }
 
     queue->is_iterator_undefined = true;
+    if (unshareStorage(queue, true) != PQ_SUCCESS)
+    {
+        return PQ_OUT_OF_MEMORY;
+    }
+
+    if (queue->max_removed_percent > 0)
+    {
+        markElementNodeRemoved(queue, handle);
+        return PQ_SUCCESS;
+    }
 
-    if(queue->element_list == NULL)
+    unlinkElementNode(queue, handle);
+    freeElementNode(queue, handle);
+
+    return PQ_SUCCESS;
+}
+
+static PriorityQueueResult removeFirstEntry(PriorityQueue queue)
+{
+    if (queue == NULL)
     {
         return PQ_NULL_ARGUMENT;
     }
 
-    ElementNode next_element = queue->element_list->next;
+    queue->is_iterator_undefined = true;
+    if (unshareStorage(queue, true) != PQ_SUCCESS)
+    {
+        return PQ_OUT_OF_MEMORY;
+    }
+
+    ElementNode first_element = getFirstElementNode(queue);
+    if(first_element == NULL)
+    {
+        return PQ_NULL_ARGUMENT;
+    }
 
-    freeElementNode(queue, queue->element_list);
-    queue->element_list = next_element;
+    unlinkElementNode(queue, first_element);
+    freeElementNode(queue, first_element);
+    freeFirstRemovedNodes(queue);
 
     return PQ_SUCCESS;
 
 }
 
-PriorityQueueResult pqRemoveElement(PriorityQueue queue, PQElement element)
+PriorityQueueResult pqRemove(PriorityQueue queue)
 {
-    if (queue == NULL || element == NULL)
+    PQ_STATS_TIMER_START(start);
+    PriorityQueueResult result = removeFirstEntry(queue);
+    PQ_STATS_TIMER_STOP(queue, PQ_STATS_REMOVE, start);
+    return result;
+}
+
+static PriorityQueueResult popFirstEntry(PriorityQueue queue, PQElement* element, PQElementPriority* priority)
+{
+    if (queue == NULL || element == NULL || priority == NULL)
     {
         return PQ_NULL_ARGUMENT;
     }
 
     queue->is_iterator_undefined = true;
-    ElementNode current_element = queue->element_list;
-    
-    // check if the first element is the one that need to remove
-    if(queue->equal_elements(current_element->element_data, element))
+    if (unshareStorage(queue, true) != PQ_SUCCESS)
+    {
+        return PQ_OUT_OF_MEMORY;
+    }
+
+    ElementNode first_element = getFirstElementNode(queue);
+    if (first_element == NULL)
     {
-        return pqRemove(queue);
+        return PQ_ELEMENT_DOES_NOT_EXISTS;
+    }
+
+    if (takeElementNodeData(queue, first_element, element, priority) != PQ_SUCCESS)
+    {
+        return PQ_OUT_OF_MEMORY;
     }
 
-    while(current_element->next != NULL){
+    unlinkElementNode(queue, first_element);
+    poolFreeNode(queue, first_element);
+    freeFirstRemovedNodes(queue);
 
-        if(queue->equal_elements(current_element->next->element_data, element))
+    return PQ_SUCCESS;
+}
+
+PriorityQueueResult pqPopTake(PriorityQueue queue, PQElement* element, PQElementPriority* priority)
+{
+    PQ_STATS_TIMER_START(start);
+    PriorityQueueResult result = popFirstEntry(queue, element, priority);
+    PQ_STATS_TIMER_STOP(queue, PQ_STATS_REMOVE, start);
+    return result;
+}
+
+PQElement pqPop(PriorityQueue queue, PQElementPriority* priority)
+{
+    PQElement element = NULL;
+    PQElementPriority element_priority = NULL;
+
+    if (pqPopTake(queue, &element, &element_priority) != PQ_SUCCESS)
+    {
+        return NULL;
+    }
+
+    if (priority != NULL)
+    {
+        *priority = element_priority;
+    }
+    else
+    {
+        FREE_PRIORITY(queue, element_priority);
+    }
+
+    return element;
+}
+
+int pqPopN(PriorityQueue queue, PQElement* elements, PQElementPriority* priorities, int count)
+{
+    if (queue == NULL || elements == NULL || count < 0)
+    {
+        return NULL_INPUT_ERROR;
+    }
+
+    int popped_count = 0;
+    while (popped_count < count)
+    {
+        elements[popped_count] = pqPop(queue, priorities != NULL ? &priorities[popped_count] : NULL);
+        if (elements[popped_count] == NULL)
         {
-            return removeElementNode(queue, current_element);
+            break;
         }
+        popped_count++;
+    }
+
+    assert(isSizeConsistent(queue));
+    return popped_count;
+}
 
-        current_element = current_element->next;
+static PriorityQueueResult removeEntry(PriorityQueue queue, PQElement element)
+{
+    if (queue == NULL || element == NULL)
+    {
+        return PQ_NULL_ARGUMENT;
     }
 
-    return PQ_ELEMENT_DOES_NOT_EXISTS;
+    queue->is_iterator_undefined = true;
+    if (unshareStorage(queue, true) != PQ_SUCCESS)
+    {
+        return PQ_OUT_OF_MEMORY;
+    }
+
+    ElementNode element_to_remove = findElementNode(queue, element, NULL);
+    if (element_to_remove == NULL)
+    {
+        return PQ_ELEMENT_DOES_NOT_EXISTS;
+    }
+
+    if (queue->max_removed_percent > 0)
+    {
+        markElementNodeRemoved(queue, element_to_remove);
+        return PQ_SUCCESS;
+    }
+
+    unlinkElementNode(queue, element_to_remove);
+    freeElementNode(queue, element_to_remove);
+
+    return PQ_SUCCESS;
 
 }
 
+PriorityQueueResult pqRemoveElement(PriorityQueue queue, PQElement element)
+{
+    PQ_STATS_TIMER_START(start);
+    PriorityQueueResult result = removeEntry(queue, element);
+    PQ_STATS_TIMER_STOP(queue, PQ_STATS_REMOVE_ELEMENT, start);
+    return result;
+}
+
 
 PriorityQueueResult pqClear(PriorityQueue queue)
 {
@@ -274,35 +759,179 @@ PriorityQueueResult pqClear(PriorityQueue queue)
         return PQ_NULL_ARGUMENT;
     }
 
+    assert(isSizeConsistent(queue));
+    queue->is_iterator_undefined = true;
+
+    // a queue that shares its entries leaves them to the other queues, without copying them
+    if (isStorageShared(queue))
+    {
+        return unshareStorage(queue, false);
+    }
+
+    if (queue->engine == PQ_ENGINE_PAIRING)
+    {
+        // link the nodes by next first, since freeing them breaks the walk over the tree
+        ElementNode nodes = NULL;
+        for (ElementNode node = queue->pairing_root; node != NULL; node = pairingNextNode(queue->pairing_root, node))
+        {
+            node->next = nodes;
+            nodes = node;
+        }
+        while (nodes != NULL)
+        {
+            ElementNode next_node = nodes->next;
+            freeElementNode(queue, nodes);
+            nodes = next_node;
+        }
+        queue->pairing_root = NULL;
+    }
+
+    if (queue->engine != PQ_ENGINE_SORTED_LIST)
+    {
+        queue->version++;
+        while (queue->heap_size > 0)
+        {
+            queue->heap_size--;
+            freeElementNode(queue, queue->heap[queue->heap_size]);
+        }
+        queue->element_list = NULL;
+        queue->is_element_list_valid = true;
+        queue->size = 0;
+        queue->removed_count = 0;
+        if (queue->buckets != NULL)
+        {
+            hashClearIndex(queue);
+        }
+        return PQ_SUCCESS;
+    }
+
     while(queue->element_list != NULL)
     {
-        pqRemove(queue);
+        removeFirstEntry(queue);
     }
 
+    assert(queue->size == 0);
     return PQ_SUCCESS;
 
 }
 
 
+PriorityQueueResult pqGetStats(PriorityQueue queue, PQStats* stats)
+{
+    if (queue == NULL || stats == NULL)
+    {
+        return PQ_NULL_ARGUMENT;
+    }
+
+#ifdef PQ_ENABLE_STATS
+    *stats = queue->stats;
+    return PQ_SUCCESS;
+#else
+    return PQ_ERROR;
+#endif
+}
+
 PQElement pqGetFirst(PriorityQueue queue)
 {
-    if (queue == NULL || queue->element_list == NULL)
+    if (queue == NULL || unshareStorageForRead(queue) != PQ_SUCCESS)
+    {
+        return NULL;
+    }
+
+    // the first node is the root of the heap engines, so the element list is built only by pqGetNext
+    ElementNode first_node = getFirstElementNode(queue);
+    if (first_node == NULL)
     {
         return NULL;
     }
 
-    queue->iterator = queue->element_list;
+    queue->iterator = first_node;
     queue->is_iterator_undefined = false;
-    return queue->iterator->element_data;
+    return first_node->element_data;
 }
 
 PQElement pqGetNext(PriorityQueue queue)
 {
-    if (queue == NULL || queue->iterator == NULL || queue->is_iterator_undefined || queue->iterator->next == NULL)
+    if (queue == NULL || queue->iterator == NULL || queue->is_iterator_undefined)
+    {
+        return NULL;
+    }
+
+    // the list holds the same nodes, and the iterator node stays at its place in it
+    getElementList(queue);
+    if (queue->iterator->next == NULL)
+    {
+        return NULL;
+    }
+
+    queue->iterator = skipRemovedNodes(queue->iterator->next);
+    return queue->iterator != NULL ? queue->iterator->element_data : NULL;
+}
+
+PQElement pqIterBegin(PriorityQueue queue, PQIterator* iterator)
+{
+    if (iterator == NULL)
+    {
+        return NULL;
+    }
+
+    // a copy that fails to get its own entries iterates over none
+    bool is_readable = queue != NULL && unshareStorageForRead(queue) == PQ_SUCCESS;
+    iterator->queue = queue;
+    iterator->current = is_readable ? skipRemovedNodes(getElementList(queue)) : NULL;
+    iterator->version = queue != NULL ? queue->version : 0;
+
+    return iterator->current != NULL ? iterator->current->element_data : NULL;
+}
+
+PQElement pqIterNext(PQIterator* iterator)
+{
+    if (iterator == NULL || iterator->current == NULL)
     {
         return NULL;
     }
 
-    queue->iterator = queue->iterator->next;
-    return queue->iterator->element_data;
+    // the nodes may have been moved or freed since the iterator started
+    if (iterator->queue->version != iterator->version)
+    {
+        iterator->current = NULL;
+        return NULL;
+    }
+
+    iterator->current = skipRemovedNodes(iterator->current->next);
+    return iterator->current != NULL ? iterator->current->element_data : NULL;
+}
+
+void pqIterEnd(PQIterator* iterator)
+{
+    if (iterator == NULL)
+    {
+        return;
+    }
+
+    iterator->queue = NULL;
+    iterator->current = NULL;
+}
+
+PriorityQueueResult pqShrinkToFit(PriorityQueue queue)
+{
+    if (queue == NULL)
+    {
+        return PQ_NULL_ARGUMENT;
+    }
+
+    // the memory of a shared storage is in use by the other queues
+    if (isStorageShared(queue))
+    {
+        return PQ_SUCCESS;
+    }
+
+    compactElementNodes(queue);
+    poolShrink(queue);
+    if (queue->engine == PQ_ENGINE_HEAP)
+    {
+        heapShrink(queue);
+    }
+
+    return PQ_SUCCESS;
 }
@@ -13,6 +13,7 @@
 *
 * The following functions are available:
 *   pqCreate		    - Creates a new empty priority queue
+*   pqCreateWithOptions - Creates a new empty priority queue with a chosen storage engine
 *   pqDestroy		    - Deletes an existing priority queue and frees all resources
 *   pqCopy		        - Copies an existing priority queue
 *   pqGetSize		    - Returns the size of a given priority queue
@@ -20,14 +21,29 @@
 *   pqInsert	        - Insert an element with a given priority to the queue.
 *   				        Duplication in the priority queue is allowed.
 *   				        Iterator value is undefined after this operation.
+*   pqInsertWithHandle  - Insert an element like pqInsert and return a handle to the inserted entry.
+*   pqInsertTake        - Insert an element like pqInsert, taking the ownership instead of copying.
+*   pqInsertBatch       - Insert many elements at once, ordering the queue only once.
+*   pqMerge             - Moves all the elements of one priority queue into another, without copying them.
 *   pqChangePriority  	- Changes priority of an element with specific priority
 *					        Iterator value is undefined after this operation.
+*   pqChangePriorityBatch - Changes the priorities of many elements at once, ordering the queue only once.
+*   pqUpdatePriorityByHandle - Changes the priority of the entry of a handle.
+*   pqRemoveByHandle    - Removes the entry of a handle.
 *   pqRemove		    - Removes the highest priority element in the queue
 *                           Iterator value is undefined after this operation.
+*   pqPopTake           - Removes the highest priority element and gives its ownership to the caller.
+*   pqPop               - Removes the highest priority element and returns it to the caller.
+*   pqPopN              - Removes up to N highest priority elements and returns them to the caller.
 *   pqGetFirst	        - Sets the internal iterator to the first element in the priority queue and returns it
 *   pqGetNext		    - Advances the internal iterator to the next key and returns it.
+*   pqIterBegin         - Starts an external iterator at the first element in the priority queue and returns it.
+*   pqIterNext          - Advances an external iterator to the next element and returns it.
+*   pqIterEnd           - Ends the iteration of an external iterator.
 *	pqClear		        - Clears the contents of the priority queue. Frees all the elements of
 *	 				        the queue using the free function.
+*   pqShrinkToFit       - Frees the memory the queue keeps for entries it does not hold.
+*   pqGetStats          - Returns the operation counters of the queue (when built with PQ_ENABLE_STATS).
 * 	PQ_FOREACH	        - A macro for iterating over the priority queue's elements.
 */
 
@@ -41,9 +57,29 @@ typedef enum PriorityQueueResult_t {
     PQ_NULL_ARGUMENT,
     PQ_ELEMENT_DOES_NOT_EXISTS,
     PQ_ITEM_DOES_NOT_EXIST,
-    PQ_ERROR
+    PQ_ERROR,
+    PQ_QUEUE_FULL
 } PriorityQueueResult;
 
+/**
+* Handle to a single entry (an element with its priority) in a priority queue.
+* A handle is valid from the insertion of its entry until the entry leaves the queue
+* (by any remove function, pqClear or pqDestroy). Using an invalid handle is undefined.
+*/
+typedef struct element_t *PQHandle;
+
+/**
+* External iterator over a priority queue. Unlike the internal iterator of pqGetFirst and pqGetNext,
+* any number of these iterators may scan the same queue at once, and they need no allocation,
+* so they are usually declared on the stack. The fields are private to the priority queue.
+* An iterator stops (returns NULL) once the queue is changed by anything other than the iterators.
+*/
+typedef struct PQIterator_t {
+    PriorityQueue queue;
+    struct element_t *current;
+    unsigned long version;
+} PQIterator;
+
 /** Data element data type for priority queue container */
 typedef void *PQElement;
 
@@ -71,6 +107,12 @@ typedef void(*FreePQElementPriority)(PQElementPriority);
 */
 typedef bool(*EqualPQElements)(PQElement, PQElement);
 
+/**
+* Type of function used by the priority queue to hash elements.
+* Elements that are equal by the EqualPQElements function must have the same hash.
+*/
+typedef unsigned int(*HashPQElement)(PQElement);
+
 
 /**
 * Type of function used by the priority queue to compare priorities.
@@ -81,6 +123,109 @@ typedef bool(*EqualPQElements)(PQElement, PQElement);
 */
 typedef int(*ComparePQElementPriorities)(PQElementPriority, PQElementPriority);
 
+/**
+* Type of function called by a bounded priority queue for an entry it evicts.
+* The element and priority are freed by the queue after the call (unless they belong to the caller
+* of the insert), so the function must not keep or free them.
+*/
+typedef void(*EvictPQElement)(PQElement, PQElementPriority);
+
+/** Type used for selecting what a bounded priority queue does with an insert when it is full */
+typedef enum PQOverflowPolicy_t {
+    PQ_OVERFLOW_EVICT,
+    PQ_OVERFLOW_REJECT
+} PQOverflowPolicy;
+
+/** Type used for selecting the internal storage of the priority queue */
+typedef enum PQEngine_t {
+    PQ_ENGINE_SORTED_LIST,
+    PQ_ENGINE_HEAP,
+    PQ_ENGINE_PAIRING
+} PQEngine;
+
+/** The operations that pqGetStats keeps latency histograms for */
+typedef enum PQStatsOperation_t {
+    PQ_STATS_INSERT,            /* pqInsert and pqInsertWithHandle */
+    PQ_STATS_REMOVE,            /* pqRemove, pqPop and pqPopTake */
+    PQ_STATS_CHANGE_PRIORITY,   /* pqChangePriority */
+    PQ_STATS_REMOVE_ELEMENT,    /* pqRemoveElement */
+    PQ_STATS_OPERATION_COUNT
+} PQStatsOperation;
+
+#define PQ_STATS_LATENCY_BUCKETS 32
+
+/**
+* Operation counters of a priority queue, since it was created.
+*   comparisons     - Calls of the compare function of the priorities.
+*   equality_checks - Calls of the equal function of the elements.
+*   copies          - Calls of the copy functions (of elements and priorities).
+*   frees           - Calls of the free functions (of elements and priorities).
+*   nodes_visited   - Nodes the queue walked over to find a place or an element.
+*   max_size        - The largest number of entries the queue held.
+*   latency_histogram - For every operation, latency_histogram[operation][i] is the number of calls
+*                     that took from 2^i to 2^(i+1) nanoseconds (the last bucket takes all the longer calls).
+*/
+typedef struct PQStats_t {
+    unsigned long comparisons;
+    unsigned long equality_checks;
+    unsigned long copies;
+    unsigned long frees;
+    unsigned long nodes_visited;
+    int max_size;
+    unsigned long latency_histogram[PQ_STATS_OPERATION_COUNT][PQ_STATS_LATENCY_BUCKETS];
+} PQStats;
+
+/**
+* Creation options of the priority queue.
+* A zero initialised PQOptions gives the default queue (the same one pqCreate returns).
+*
+*   engine      - PQ_ENGINE_SORTED_LIST keeps the elements in a sorted linked list (O(n) insert, O(1) remove).
+*                 PQ_ENGINE_HEAP keeps the elements in an array based d-ary heap (O(log n) insert and remove).
+*                 PQ_ENGINE_PAIRING keeps the elements in a pairing heap (O(1) insert, raising a priority and
+*                 pqMerge of two pairing queues, O(log n) amortised remove). Best for frequent priority changes.
+*   heap_arity  - Number of children of every heap node, used only by PQ_ENGINE_HEAP. 0 selects the default (4).
+*   hash_element - Optional (may be NULL). When given, the queue keeps a hash index from elements to their
+*                 nodes, so pqContains, pqRemoveElement and pqChangePriority find the element in expected O(1)
+*                 instead of scanning the whole queue.
+*   initial_capacity - Number of entries to allocate room for at creation. The queue allocates its nodes
+*                 in slabs and reuses the nodes of removed entries, so a queue that stays within its
+*                 capacity does not allocate nodes at all. 0 allocates on demand.
+*   capacity    - Maximal number of entries in the queue (top-K mode). 0 means unbounded.
+*                 When the queue is full, an insert is handled by overflow_policy.
+*   overflow_policy - PQ_OVERFLOW_EVICT keeps the capacity highest entries: the entry that comes last
+*                 (the lowest priority, and between equal priorities the last inserted) is evicted,
+*                 and that may be the inserted entry itself. PQ_ENGINE_SORTED_LIST finds the last entry
+*                 in O(1) (an insert into a full queue costs O(K) like any other insert into it), and
+*                 PQ_ENGINE_HEAP keeps a second heap of its entries with the last one at the root, so an
+*                 insert into a full queue costs O(log K). PQ_ENGINE_PAIRING cannot evict, since its tree
+*                 keeps no order among the last entries.
+*                 PQ_OVERFLOW_REJECT fails the insert with PQ_QUEUE_FULL, and works with every engine.
+*   evict_element - Optional (may be NULL). Called for every entry evicted by PQ_OVERFLOW_EVICT.
+*   element_size - Size in bytes of every element, for elements that can be copied with memcpy.
+*                 When given, the elements are stored inside the nodes of the queue instead of being
+*                 allocated by copy_element, and copy_element and free_element are used only for the
+*                 elements the queue gives away (pqPop, pqPopTake) or takes (pqInsertTake).
+*                 0 means the elements are allocated by the copy functions.
+*   priority_size - The same as element_size, for the priorities.
+*   max_removed_percent - 0 (the default) frees the entries removed by pqRemoveElement and pqRemoveByHandle
+*                 at once. Otherwise the removal is lazy: the entry is only marked as removed (a tombstone),
+*                 and is skipped by the lookups, the iteration and the pops, and the removed entries are
+*                 freed together once they are more than max_removed_percent percent (1 to 100) of the
+*                 entries of the queue. Saves the reordering of the queue when many entries are cancelled.
+*/
+typedef struct PQOptions_t {
+    PQEngine engine;
+    int heap_arity;
+    HashPQElement hash_element;
+    int initial_capacity;
+    int capacity;
+    PQOverflowPolicy overflow_policy;
+    EvictPQElement evict_element;
+    int element_size;
+    int priority_size;
+    int max_removed_percent;
+} PQOptions;
+
 
 /**
 * pqCreate: Allocates a new empty priority queue.
@@ -108,6 +253,26 @@ PriorityQueue pqCreate(CopyPQElement copy_element,
                        FreePQElementPriority free_priority,
                        ComparePQElementPriorities compare_priorities);
 
+/**
+* pqCreateWithOptions: Allocates a new empty priority queue with the given creation options.
+* The queue keeps the same contract as a queue created by pqCreate, including the insertion
+* order tie-breaker between equal priorities, whatever engine is selected.
+*
+* @param copy_element, free_element, equal_elements, copy_priority, free_priority, compare_priorities -
+*       Same as in pqCreate.
+* @param options - The creation options. If NULL the default options are used.
+* @return
+* 	NULL - if one of the function parameters is NULL, the options are illegal or allocations failed.
+* 	A new priority queue in case of success.
+*/
+PriorityQueue pqCreateWithOptions(CopyPQElement copy_element,
+                                  FreePQElement free_element,
+                                  EqualPQElements equal_elements,
+                                  CopyPQElementPriority copy_priority,
+                                  FreePQElementPriority free_priority,
+                                  ComparePQElementPriorities compare_priorities,
+                                  const PQOptions* options);
+
 /**
 * pqDestroy: Deallocates an existing priority queue. Clears all elements by using the
 * free functions.
@@ -120,6 +285,13 @@ void pqDestroy(PriorityQueue queue);
 /**
 * pqCopy: Creates a copy of target priority queue.
 * Iterator values for both priority queues are undefined after this operation.
+* Sharing is O(1) for every engine: both queues share the same entries until one of them changes, or
+* until the copy gives out an element (pqGetFirst, pqGetNext or pqIterBegin), and the entries are copied
+* with the copy functions only then, so pqGetFirst and pqIterBegin of a copy return NULL if that fails.
+* Any change of one of the queues may return PQ_OUT_OF_MEMORY. An element returned by a copy stays valid
+* until the next change of that copy. Handles and elements of the copied queue are not affected.
+* Copy functions that count references instead of copying make the copying of the entries allocation
+* free as well.
 *
 * @param queue - Target priority queue.
 * @return
@@ -164,10 +336,96 @@ bool pqContains(PriorityQueue queue, PQElement element);
 * 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters
 * 	PQ_OUT_OF_MEMORY if an allocation failed (Meaning the function for copying
 * 	an element failed)
-* 	PQ_SUCCESS the paired elements had been inserted successfully
+* 	PQ_QUEUE_FULL if the queue is bounded, full, and rejects inserts when full
+* 	PQ_SUCCESS the paired elements had been inserted successfully (or evicted right away,
+* 	in a full bounded queue that evicts)
 */
 PriorityQueueResult pqInsert(PriorityQueue queue, PQElement element, PQElementPriority priority);
 
+/**
+*   pqInsertWithHandle: add a specified element with a specific priority, like pqInsert,
+*   and return a handle to the new entry.
+*   Iterator's value is undefined after this operation.
+*
+* @param queue - The priority queue for which to add the data element
+* @param element - The element which need to be added.
+* @param priority - The priority to associate with the given element.
+* @param handle - Pointer to assign the handle of the new entry into. NULL is assigned if the
+*       entry was evicted right away by a full bounded queue.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters
+* 	PQ_OUT_OF_MEMORY if an allocation failed
+* 	PQ_QUEUE_FULL if the queue is bounded, full, and rejects inserts when full
+* 	PQ_SUCCESS the paired elements had been inserted successfully
+*/
+PriorityQueueResult pqInsertWithHandle(PriorityQueue queue, PQElement element, PQElementPriority priority,
+                                       PQHandle* handle);
+
+/**
+*   pqInsertTake: add a specified element with a specific priority, like pqInsert, but without copying them.
+*   The queue takes the ownership of element and priority, and frees them with the free functions
+*   when they are removed. The caller must not use or free them after a successful insert.
+*   A queue with inline elements or priorities (see PQOptions) copies them in and frees them right away.
+*   Iterator's value is undefined after this operation.
+*
+* @param queue - The priority queue for which to add the data element
+* @param element - The element to add. It must be allocated the same way the copy function allocates.
+* @param priority - The priority to add. It must be allocated the same way the copy function allocates.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters
+* 	PQ_OUT_OF_MEMORY if an allocation failed. The caller keeps the ownership in that case.
+* 	PQ_QUEUE_FULL if the queue is bounded, full, and rejects inserts when full.
+* 	The caller keeps the ownership in that case.
+* 	PQ_SUCCESS the paired elements had been inserted successfully
+*/
+PriorityQueueResult pqInsertTake(PriorityQueue queue, PQElement element, PQElementPriority priority);
+
+/**
+*   pqInsertBatch: add count elements with their priorities, like calling pqInsert on each of them in
+*   the array order (so between equal priorities, a lower index comes first), but in O(n + k log k) time
+*   instead of O(n * k) for the sorted list engine, and O(n + k) for the heap engine.
+*   Nothing is inserted if an allocation fails. In a bounded queue that evicts, the entries that do not fit
+*   are evicted after the batch is inserted, and in a bounded queue that rejects, nothing is inserted
+*   if the whole batch does not fit.
+*   Iterator's value is undefined after this operation.
+*
+* @param queue - The priority queue for which to add the data elements
+* @param elements - Array of count elements to add. A copy of each element is inserted.
+* @param priorities - Array of count priorities, priorities[i] is the priority of elements[i].
+* @param count - The number of elements to add.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters or is in one of the arrays
+* 	PQ_ERROR if count is negative
+* 	PQ_OUT_OF_MEMORY if an allocation failed
+* 	PQ_QUEUE_FULL if the queue is bounded, rejects inserts when full, and the batch does not fit
+* 	PQ_SUCCESS the elements had been inserted successfully
+*/
+PriorityQueueResult pqInsertBatch(PriorityQueue queue, PQElement* elements, PQElementPriority* priorities,
+                                  int count);
+
+/**
+*   pqMerge: Moves all the elements of source, with their priorities, into destination, and leaves
+*   source empty. The elements are not copied - their nodes move, so handles to entries of source
+*   become handles to the same entries in destination. Between equal priorities the entry that was
+*   inserted first (to any of the queues) comes first.
+*   Takes O(n + m) time for the sorted list engine and for the heap engine, and O(1) to merge
+*   two pairing queues (O(m) if one of them has a hash index).
+*   In a bounded destination that evicts, the entries that do not fit are evicted after the merge,
+*   and in a bounded destination that rejects, nothing is moved if the entries of source do not fit.
+*   Iterator's value is undefined for both queues after this operation.
+*
+* @param destination - The priority queue to move the elements into.
+* @param source - The priority queue to move the elements from. It must use the same copy, free
+*       and compare functions as destination, but may use another engine or options.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters
+* 	PQ_ERROR if both are the same queue, their functions are different or their inline sizes are different
+* 	PQ_OUT_OF_MEMORY if an allocation failed. No entry is moved in that case.
+* 	PQ_QUEUE_FULL if destination is bounded, rejects inserts when full, and the entries do not fit
+* 	PQ_SUCCESS the elements had been moved successfully
+*/
+PriorityQueueResult pqMerge(PriorityQueue destination, PriorityQueue source);
+
 /**
 *	pqChangePriority: Changes a priority of specific element with a specific priority in the priority queue.
 *           If there are multiple same elements with same priority,
@@ -189,6 +447,62 @@ PriorityQueueResult pqInsert(PriorityQueue queue, PQElement element, PQElementPr
 PriorityQueueResult pqChangePriority(PriorityQueue queue, PQElement element,
                                      PQElementPriority old_priority, PQElementPriority new_priority);
 
+/**
+*   pqChangePriorityBatch: Changes the priorities of count elements, like calling pqChangePriority on each of
+*   them in the array order (so between equal new priorities, a lower index comes first), but orders the
+*   queue once for the whole batch: O(n + k log k) for the sorted list engine instead of O(n * k).
+*   Every change is made on a different entry, so two changes of the same element with the same old
+*   priority change two of its entries. Finding the entries is O(k) with a hash index (see PQOptions),
+*   and one walk over the queue (O(n log k)) otherwise.
+*   Nothing is changed if an element is not found or an allocation fails.
+*   Iterator's value is undefined after this operation.
+*
+* @param queue - The priority queue of the elements.
+* @param elements - Array of count elements to change.
+* @param old_priorities - Array of count priorities, old_priorities[i] is the current priority of elements[i].
+* @param new_priorities - Array of count priorities, new_priorities[i] is the new priority of elements[i].
+* @param count - The number of elements to change.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters or is in one of the arrays
+* 	PQ_ERROR if count is negative
+* 	PQ_OUT_OF_MEMORY if an allocation failed
+* 	PQ_ELEMENT_DOES_NOT_EXISTS if one of the elements with its old priority does not exists in the queue.
+* 	PQ_SUCCESS the priorities had been changed successfully
+*/
+PriorityQueueResult pqChangePriorityBatch(PriorityQueue queue, PQElement* elements, PQElementPriority* old_priorities,
+                                          PQElementPriority* new_priorities, int count);
+
+/**
+*   pqUpdatePriorityByHandle: Changes the priority of the entry of handle.
+*           The entry keeps its element (it is not copied again) and its handle stays valid.
+*           Only the new priority is copied, and the old one is freed.
+*           The entry is considered as reinserted entry.
+*			Iterator's value is undefined after this operation
+*
+* @param queue - The priority queue that holds the entry.
+* @param handle - The handle of the entry.
+* @param new_priority - The new priority of the entry.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters
+* 	PQ_OUT_OF_MEMORY if copying the priority failed. The entry is not changed in that case.
+* 	PQ_SUCCESS the priority had been changed successfully
+*/
+PriorityQueueResult pqUpdatePriorityByHandle(PriorityQueue queue, PQHandle handle, PQElementPriority new_priority);
+
+/**
+*   pqRemoveByHandle: Removes the entry of handle from the priority queue.
+*   the element and priority are deallocated using the free functions supplied at initialization,
+*   and the handle is not valid after this operation.
+*   Iterator's value is undefined after this operation.
+*
+* @param queue - The priority queue that holds the entry.
+* @param handle - The handle of the entry.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent to the function.
+* 	PQ_SUCCESS the entry had been removed successfully.
+*/
+PriorityQueueResult pqRemoveByHandle(PriorityQueue queue, PQHandle handle);
+
 /**
 *   pqRemove: Removes the highest priority element from the priority queue.
 *   If there are multiple elements with the same highest priority, the first inserted element should be removed first.
@@ -202,6 +516,55 @@ PriorityQueueResult pqChangePriority(PriorityQueue queue, PQElement element,
 */
 PriorityQueueResult pqRemove(PriorityQueue queue);
 
+/**
+*   pqPopTake: Removes the highest priority element from the priority queue, like pqRemove,
+*   but gives the element and its priority to the caller instead of freeing them.
+*   The caller is responsible for freeing them (with the free functions of the queue).
+*   Iterator's value is undefined after this operation.
+*
+* @param queue - The priority queue to remove the element from.
+* @param element - Pointer to assign the removed element into.
+* @param priority - Pointer to assign the priority of the removed element into.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent to the function.
+* 	PQ_ELEMENT_DOES_NOT_EXISTS if the queue is empty.
+* 	PQ_OUT_OF_MEMORY if the queue stores its elements or priorities inline and copying them out failed.
+* 	The element is not removed in that case.
+* 	PQ_SUCCESS the most prioritized element had been removed successfully.
+*/
+PriorityQueueResult pqPopTake(PriorityQueue queue, PQElement* element, PQElementPriority* priority);
+
+/**
+*   pqPop: Removes the highest priority element from the priority queue and returns it.
+*   The caller gets the ownership of the returned element (and of its priority, if requested)
+*   and is responsible for freeing it with the free functions of the queue.
+*   Iterator's value is undefined after this operation.
+*
+* @param queue - The priority queue to remove the element from.
+* @param priority - Pointer to assign the priority of the removed element into.
+*       If NULL, the priority is freed with the free function of the queue.
+* @return
+* 	NULL if a NULL was sent as queue or the queue is empty.
+* 	The removed element otherwise.
+*/
+PQElement pqPop(PriorityQueue queue, PQElementPriority* priority);
+
+/**
+*   pqPopN: Removes up to count highest priority elements from the priority queue, in the queue order,
+*   and stores them in elements (and their priorities in priorities, if it is not NULL).
+*   The caller gets the ownership of the stored elements and priorities, like in pqPop.
+*   Iterator's value is undefined after this operation.
+*
+* @param queue - The priority queue to remove the elements from.
+* @param elements - Array of at least count places to store the removed elements in.
+* @param priorities - Array of at least count places to store the priorities in, or NULL to free them.
+* @param count - The maximal number of elements to remove.
+* @return
+* 	-1 if a NULL was sent as queue or elements, or count is negative.
+* 	Otherwise the number of elements removed (less than count if the queue became empty).
+*/
+int pqPopN(PriorityQueue queue, PQElement* elements, PQElementPriority* priorities, int count);
+
 /**
 *   pqRemoveElement: Removes the highest priority element from the priority queue which have its value equal to element.
 *   If there are multiple elements with the same highest priority, the first inserted element should be removed first.
@@ -245,6 +608,37 @@ PQElement pqGetFirst(PriorityQueue queue);
 */
 PQElement pqGetNext(PriorityQueue queue);
 
+/**
+*	pqIterBegin: Starts an external iterator at the first element in the priority queue, in the
+*   same order as pqGetFirst. Does not change the internal iterator or other external iterators.
+*
+* @param queue - The priority queue to iterate over.
+* @param iterator - The iterator to start.
+* @return
+* 	NULL if a NULL pointer was sent or the priority queue is empty.
+* 	The first element of the priority queue otherwise
+*/
+PQElement pqIterBegin(PriorityQueue queue, PQIterator* iterator);
+
+/**
+*	pqIterNext: Advances an external iterator to the next element and returns it.
+*
+* @param iterator - The iterator to advance.
+* @return
+* 	NULL if reached the end of the priority queue, the queue was changed since pqIterBegin,
+* 	the iteration was ended or a NULL sent as argument
+* 	The next element on the priority queue in case of success
+*/
+PQElement pqIterNext(PQIterator* iterator);
+
+/**
+*	pqIterEnd: Ends the iteration of an external iterator. pqIterNext returns NULL afterwards,
+*   until the iterator is started again.
+*
+* @param iterator - The iterator to end. If NULL nothing will be done
+*/
+void pqIterEnd(PQIterator* iterator);
+
 /**
 * pqClear: Removes all elements and priorities from target priority queue.
 * The elements are deallocated using the stored free functions.
@@ -256,6 +650,35 @@ PQElement pqGetNext(PriorityQueue queue);
 */
 PriorityQueueResult pqClear(PriorityQueue queue);
 
+/**
+* pqShrinkToFit: Frees the memory that the priority queue keeps for reuse - the node slabs
+* with no entry in them and the unused part of the heap array.
+* Entries removed lazily (see max_removed_percent) are freed as well, which ends the external iterators
+* of the queue (pqIterNext returns NULL). Without such entries the external iterators go on.
+* The entries of the queue and the internal iterator are not changed.
+* @param queue
+* 	Target priority queue.
+* @return
+* 	PQ_NULL_ARGUMENT - if a NULL pointer was sent.
+* 	PQ_SUCCESS - Otherwise.
+*/
+PriorityQueueResult pqShrinkToFit(PriorityQueue queue);
+
+/**
+*   pqGetStats: Copies the operation counters of the priority queue (see PQStats) into stats.
+*   The counters are kept only when the queue is built with PQ_ENABLE_STATS defined, so a release build
+*   does not pay for them. The counters belong to the queue and not to its entries, so a copy of a queue
+*   starts with zero counters, and pqMerge does not move them.
+*
+* @param queue - The priority queue to get the counters of.
+* @param stats - Pointer to copy the counters into.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters
+* 	PQ_ERROR if the queue was built without PQ_ENABLE_STATS. stats is not changed in that case.
+* 	PQ_SUCCESS the counters had been copied successfully
+*/
+PriorityQueueResult pqGetStats(PriorityQueue queue, PQStats* stats);
+
 /*!
 * Macro for iterating over a priority queue.
 * Declares a new iterator for the loop.
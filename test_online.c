@@ -1,6 +1,11 @@
 #include <stdlib.h>
+#include <limits.h>
+#include <pthread.h>
 #include "test_utilities.h"
 #include "priority_queue.h"
+#include "concurrent_priority_queue.h"
+#include "int_priority_queue.h"
+#include "pq_typed.h"
 
 #define PQ PriorityQueue
 
@@ -29,6 +34,36 @@ static bool equalIntsGeneric(PQElementPriority n1, PQElementPriority n2) {
     return *(int *) n1 == *(int *) n2;
 }
 
+static unsigned int hashIntGeneric(PQElement n) {
+    return (unsigned int) *(int *) n;
+}
+
+static int compared_count = 0;
+
+static int compareIntsCounting(PQElementPriority n1, PQElementPriority n2) {
+    compared_count++;
+    return compareIntsGeneric(n1, n2);
+}
+
+static int evicted_count = 0;
+static int evicted_sum = 0;
+
+static void countEvictedGeneric(PQElement element, PQElementPriority priority) {
+    evicted_count++;
+    evicted_sum += *(int *) element;
+}
+
+
+static inline int compareIntValues(int first, int second) {
+    return first - second;
+}
+
+static inline bool equalIntValues(int first, int second) {
+    return first == second;
+}
+
+PQ_DEFINE(TypedIntQueue, int, int, compareIntValues, equalIntValues)
+
 
 int *randInt() {
     int *num = malloc(sizeof(int));
@@ -42,6 +77,20 @@ PriorityQueue createPQ() {
     return pq;
 }
 
+PriorityQueue createHeapPQ(int heap_arity) {
+    PQOptions options = {PQ_ENGINE_HEAP, heap_arity};
+    PriorityQueue pq = pqCreateWithOptions(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric,
+                                           freeIntGeneric, compareIntsGeneric, &options);
+    return pq;
+}
+
+PriorityQueue createHashedPQ(PQEngine engine) {
+    PQOptions options = {.engine = engine, .hash_element = hashIntGeneric};
+    PriorityQueue pq = pqCreateWithOptions(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric,
+                                           freeIntGeneric, compareIntsGeneric, &options);
+    return pq;
+}
+
 PriorityQueue getSingleElementPQ() {
     PriorityQueue pq = createPQ();
     int *element = randInt();
@@ -245,6 +294,48 @@ bool testPQGetSizeStandardTest() {
 }
 
 
+bool testPQGetSizeFollowsAllChanges() {
+    bool result = true;
+    PQ pq = createPQ();
+    PQ heap_pq = createHeapPQ(0);
+    PQ copy = NULL;
+
+    int elems[] = {4, 8, 15, 16, 23, 42};
+    for (int i = 0; i < 6; i++) {
+        pqInsert(pq, &elems[i], &elems[i]);
+        pqInsert(heap_pq, &elems[i], &elems[i]);
+    }
+
+    int new_prio = 1;
+    ASSERT_TEST(pqChangePriority(pq, &elems[2], &elems[2], &new_prio) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqChangePriority(heap_pq, &elems[2], &elems[2], &new_prio) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqGetSize(pq) == 6 && pqGetSize(heap_pq) == 6, destroy);
+
+    ASSERT_TEST(pqChangePriority(pq, &elems[2], &elems[2], &new_prio) == PQ_ELEMENT_DOES_NOT_EXISTS, destroy);
+    ASSERT_TEST(pqGetSize(pq) == 6, destroy);
+
+    pqRemoveElement(pq, &elems[0]);
+    pqRemoveElement(heap_pq, &elems[0]);
+    pqRemove(pq);
+    pqRemove(heap_pq);
+    ASSERT_TEST(pqGetSize(pq) == 4 && pqGetSize(heap_pq) == 4, destroy);
+
+    copy = pqCopy(heap_pq);
+    ASSERT_TEST(pqGetSize(copy) == 4, destroy);
+    pqClear(copy);
+    ASSERT_TEST(pqGetSize(copy) == 0, destroy);
+    pqDestroy(copy);
+
+    copy = pqCopy(pq);
+    ASSERT_TEST(pqGetSize(copy) == 4, destroy);
+
+    destroy:
+    pqDestroy(copy);
+    pqDestroy(pq);
+    pqDestroy(heap_pq);
+    return result;
+}
+
 
 /* ============= TESTING pqContains ============= */
 // TODO: add
@@ -711,6 +802,1460 @@ bool testPQClearStandardTest() {
 
 
 
+/* ============= TESTING the heap engine ============= */
+bool testPQCreateWithOptionsIllegalOptions() {
+    bool result = true;
+    PQOptions options = {PQ_ENGINE_HEAP, 1};
+    PQ pq = pqCreateWithOptions(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric,
+                                freeIntGeneric, compareIntsGeneric, &options);
+    ASSERT_TEST(pq == NULL, destroy);
+
+    pq = pqCreateWithOptions(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric,
+                             freeIntGeneric, compareIntsGeneric, NULL);
+    ASSERT_TEST(pq != NULL, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    return result;
+}
+
+bool testPQHeapKeepsInsertionOrderBetweenEqualPriorities() {
+    bool result = true;
+    PQ pq = createHeapPQ(2);
+
+    int prio = 7;
+    int low_prio = 1;
+    for (int i = 0; i < 20; i++) {
+        ASSERT_TEST(pqInsert(pq, &i, i % 2 == 0 ? &prio : &low_prio) == PQ_SUCCESS, destroy);
+    }
+
+    int expected = 0;
+    PQ_FOREACH(int *, elem, pq) {
+        ASSERT_TEST(*elem == expected, destroy);
+        expected = expected == 18 ? 1 : expected + 2;
+    }
+
+    for (int i = 0; i < 20; i += 2) {
+        ASSERT_TEST(*(int *) pqGetFirst(pq) == i, destroy);
+        ASSERT_TEST(pqRemove(pq) == PQ_SUCCESS, destroy);
+    }
+    ASSERT_TEST(pqGetSize(pq) == 10, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    return result;
+}
+
+bool testPQHeapMatchesSortedList() {
+    bool result = true;
+    PQ list_pq = createPQ();
+    PQ heap_pq = createHeapPQ(0);
+
+    for (int i = 0; i < 300; i++) {
+        int *prio = randInt();
+        *prio %= 40;
+        pqInsert(list_pq, &i, prio);
+        pqInsert(heap_pq, &i, prio);
+        free(prio);
+    }
+
+    int elem = 100;
+    int old_prio = 0;
+    int new_prio = 45;
+    pqRemoveElement(list_pq, &elem);
+    pqRemoveElement(heap_pq, &elem);
+    for (elem = 0; elem < 300; elem += 7) {
+        for (old_prio = 0; old_prio < 40; old_prio++) {
+            if (pqChangePriority(list_pq, &elem, &old_prio, &new_prio) == PQ_SUCCESS) {
+                ASSERT_TEST(pqChangePriority(heap_pq, &elem, &old_prio, &new_prio) == PQ_SUCCESS, destroy);
+                break;
+            }
+        }
+    }
+
+    PQ heap_copy = pqCopy(heap_pq);
+    ASSERT_TEST(heap_copy != NULL, destroy);
+    ASSERT_TEST(pqGetSize(heap_copy) == pqGetSize(list_pq), destroyCopy);
+
+    int *heap_elem = pqGetFirst(heap_copy);
+    PQ_FOREACH(int *, list_elem, list_pq) {
+        ASSERT_TEST(heap_elem != NULL && *heap_elem == *list_elem, destroyCopy);
+        heap_elem = pqGetNext(heap_copy);
+    }
+
+    while (pqGetSize(list_pq) > 0) {
+        ASSERT_TEST(*(int *) pqGetFirst(list_pq) == *(int *) pqGetFirst(heap_pq), destroyCopy);
+        pqRemove(list_pq);
+        pqRemove(heap_pq);
+    }
+    ASSERT_TEST(pqGetFirst(heap_pq) == NULL, destroyCopy);
+
+    destroyCopy:
+    pqDestroy(heap_copy);
+    destroy:
+    pqDestroy(list_pq);
+    pqDestroy(heap_pq);
+    return result;
+}
+
+bool testPQPairingMatchesSortedList() {
+    bool result = true;
+    PQOptions pairing_options = {.engine = PQ_ENGINE_PAIRING};
+    PQ list_pq = createPQ();
+    PQ pairing_pq = createHashedPQ(PQ_ENGINE_PAIRING);
+    PQ other_pairing_pq = pqCreateWithOptions(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric,
+                                              freeIntGeneric, compareIntsGeneric, &pairing_options);
+    PQ pairing_copy = NULL;
+    PQHandle handles[300];
+    ASSERT_TEST(pairing_pq != NULL && other_pairing_pq != NULL, destroy);
+
+    for (int i = 0; i < 300; i++) {
+        int prio = rand() % 40;
+        PQHandle list_handle;
+        pqInsertWithHandle(list_pq, &i, &prio, &list_handle);
+        pqInsertWithHandle(i < 200 ? pairing_pq : other_pairing_pq, &i, &prio, &handles[i]);
+    }
+    ASSERT_TEST(pqMerge(pairing_pq, other_pairing_pq) == PQ_SUCCESS && pqGetSize(other_pairing_pq) == 0, destroy);
+
+    // raise and lower priorities through handles and through the elements
+    for (int i = 0; i < 300; i += 3) {
+        int new_prio = i % 2 == 0 ? 45 : -1;
+        int old_prio;
+        for (old_prio = 0; old_prio < 40; old_prio++) {
+            if (pqChangePriority(list_pq, &i, &old_prio, &new_prio) == PQ_SUCCESS) {
+                break;
+            }
+        }
+        if (i % 6 == 0) {
+            ASSERT_TEST(pqUpdatePriorityByHandle(pairing_pq, handles[i], &new_prio) == PQ_SUCCESS, destroy);
+        } else {
+            ASSERT_TEST(pqChangePriority(pairing_pq, &i, &old_prio, &new_prio) == PQ_SUCCESS, destroy);
+        }
+    }
+    for (int i = 1; i < 300; i += 10) {
+        ASSERT_TEST(pqRemoveElement(list_pq, &i) == PQ_SUCCESS, destroy);
+        ASSERT_TEST(pqRemoveElement(pairing_pq, &i) == PQ_SUCCESS, destroy);
+    }
+
+    pairing_copy = pqCopy(pairing_pq);
+    ASSERT_TEST(pairing_copy != NULL && pqGetSize(pairing_copy) == pqGetSize(list_pq), destroy);
+    ASSERT_TEST(pqRemove(pairing_copy) == PQ_SUCCESS, destroy);
+
+    int *pairing_elem = pqGetFirst(pairing_pq);
+    PQ_FOREACH(int *, list_elem, list_pq) {
+        ASSERT_TEST(pairing_elem != NULL && *pairing_elem == *list_elem, destroy);
+        pairing_elem = pqGetNext(pairing_pq);
+    }
+
+    pqRemove(list_pq);
+    while (pqGetSize(list_pq) > 0) {
+        ASSERT_TEST(*(int *) pqGetFirst(list_pq) == *(int *) pqGetFirst(pairing_copy), destroy);
+        pqRemove(list_pq);
+        pqRemove(pairing_copy);
+    }
+    ASSERT_TEST(pqGetFirst(pairing_copy) == NULL && pqGetSize(pairing_pq) > 0, destroy);
+
+    destroy:
+    pqDestroy(list_pq);
+    pqDestroy(pairing_pq);
+    pqDestroy(other_pairing_pq);
+    pqDestroy(pairing_copy);
+    return result;
+}
+
+bool testPQInlineStorageMatchesCallbacks() {
+    bool result = true;
+    PQOptions inline_options = {.engine = PQ_ENGINE_HEAP, .hash_element = hashIntGeneric,
+                                .element_size = sizeof(int), .priority_size = sizeof(int)};
+    PQOptions priority_options = {.engine = PQ_ENGINE_PAIRING, .priority_size = sizeof(int)};
+    PQ pq = createPQ();
+    PQ inline_pq = pqCreateWithOptions(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric,
+                                       freeIntGeneric, compareIntsGeneric, &inline_options);
+    PQ priority_pq = pqCreateWithOptions(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric,
+                                         freeIntGeneric, compareIntsGeneric, &priority_options);
+    PQ copy = NULL;
+    ASSERT_TEST(inline_pq != NULL && priority_pq != NULL, destroy);
+
+    for (int i = 0; i < 100; i++) {
+        int prio = rand() % 20;
+        if (i % 2 == 0) {
+            pqInsert(pq, &i, &prio);
+        }
+        ASSERT_TEST(pqInsert(i % 2 == 0 ? inline_pq : priority_pq, &i, &prio) == PQ_SUCCESS, destroy);
+    }
+    int *taken_elem = copyIntGeneric(&(int){100});
+    int *taken_prio = copyIntGeneric(&(int){30});
+    pqInsert(pq, taken_elem, taken_prio);
+    ASSERT_TEST(pqInsertTake(inline_pq, taken_elem, taken_prio) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqMerge(inline_pq, priority_pq) == PQ_ERROR, destroy);
+
+    // move the odd elements into inline_pq one by one, changing some priorities on the way
+    while (pqGetSize(priority_pq) > 0) {
+        int *prio;
+        int *elem = pqPop(priority_pq, (PQElementPriority *) &prio);
+        ASSERT_TEST(elem != NULL && pqInsert(inline_pq, elem, prio) == PQ_SUCCESS, destroy);
+        pqInsert(pq, elem, prio);
+        if (*elem % 3 == 0) {
+            int new_prio = *elem % 2 == 0 ? 25 : -1;
+            ASSERT_TEST(pqChangePriority(pq, elem, prio, &new_prio) == PQ_SUCCESS, destroy);
+            ASSERT_TEST(pqChangePriority(inline_pq, elem, prio, &new_prio) == PQ_SUCCESS, destroy);
+        }
+        free(elem);
+        free(prio);
+    }
+    ASSERT_TEST(pqContains(inline_pq, &(int){51}) && !pqContains(inline_pq, &(int){101}), destroy);
+
+    copy = pqCopy(inline_pq);
+    ASSERT_TEST(copy != NULL && pqRemove(copy) == PQ_SUCCESS && pqGetSize(copy) == pqGetSize(pq) - 1, destroy);
+
+    while (pqGetSize(pq) > 0) {
+        int *elem, *prio;
+        ASSERT_TEST(pqPopTake(inline_pq, (PQElement *) &elem, (PQElementPriority *) &prio) == PQ_SUCCESS, destroy);
+        bool is_same = *elem == *(int *) pqGetFirst(pq);
+        free(elem);
+        free(prio);
+        ASSERT_TEST(is_same, destroy);
+        pqRemove(pq);
+    }
+    ASSERT_TEST(pqGetSize(inline_pq) == 0, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    pqDestroy(inline_pq);
+    pqDestroy(priority_pq);
+    pqDestroy(copy);
+    return result;
+}
+
+bool testTypedPQMatchesPriorityQueue() {
+    bool result = true;
+    PQ pq = createPQ();
+    TypedIntQueue typed_pq = TypedIntQueueCreate();
+    TypedIntQueue typed_copy = NULL;
+    ASSERT_TEST(typed_pq != NULL && TypedIntQueueGetFirst(typed_pq) == NULL, destroy);
+
+    for (int i = 0; i < 300; i++) {
+        int prio = rand() % 30;
+        pqInsert(pq, &i, &prio);
+        ASSERT_TEST(TypedIntQueueInsert(typed_pq, i, prio) == PQ_SUCCESS, destroy);
+    }
+    for (int i = 0; i < 300; i += 7) {
+        int new_prio = i % 2 == 0 ? 35 : -1;
+        int old_prio;
+        for (old_prio = 0; old_prio < 30; old_prio++) {
+            if (pqChangePriority(pq, &i, &old_prio, &new_prio) == PQ_SUCCESS) {
+                break;
+            }
+        }
+        ASSERT_TEST(TypedIntQueueChangePriority(typed_pq, i, old_prio, new_prio) == PQ_SUCCESS, destroy);
+        ASSERT_TEST(TypedIntQueueChangePriority(typed_pq, i, old_prio, new_prio) == PQ_ELEMENT_DOES_NOT_EXISTS,
+                    destroy);
+    }
+    for (int i = 3; i < 300; i += 11) {
+        pqRemoveElement(pq, &i);
+        ASSERT_TEST(TypedIntQueueRemoveElement(typed_pq, i) == PQ_SUCCESS, destroy);
+    }
+    ASSERT_TEST(!TypedIntQueueContains(typed_pq, 14) && TypedIntQueueContains(typed_pq, 15), destroy);
+    ASSERT_TEST(TypedIntQueueGetSize(typed_pq) == pqGetSize(pq), destroy);
+
+    typed_copy = TypedIntQueueCopy(typed_pq);
+    ASSERT_TEST(typed_copy != NULL && TypedIntQueueClear(typed_pq) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(TypedIntQueueGetSize(typed_pq) == 0 && TypedIntQueueRemove(typed_pq) == PQ_NULL_ARGUMENT, destroy);
+
+    while (pqGetSize(pq) > 0) {
+        int elem;
+        ASSERT_TEST(*TypedIntQueueGetFirst(typed_copy) == *(int *) pqGetFirst(pq), destroy);
+        ASSERT_TEST(TypedIntQueuePop(typed_copy, &elem, NULL) == PQ_SUCCESS, destroy);
+        ASSERT_TEST(elem == *(int *) pqGetFirst(pq), destroy);
+        pqRemove(pq);
+    }
+    ASSERT_TEST(TypedIntQueuePop(typed_copy, &(int){0}, NULL) == PQ_ELEMENT_DOES_NOT_EXISTS, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    TypedIntQueueDestroy(typed_pq);
+    TypedIntQueueDestroy(typed_copy);
+    return result;
+}
+
+bool testPQChangePriorityBatchMatchesSingleChanges() {
+    bool result = true;
+    PQ pq = createPQ();
+    PQOptions pairing_options = {.engine = PQ_ENGINE_PAIRING};
+    PQ batch_pqs[4] = {createPQ(), createHeapPQ(3), createHashedPQ(PQ_ENGINE_PAIRING),
+                       pqCreateWithOptions(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric,
+                                           freeIntGeneric, compareIntsGeneric, &pairing_options)};
+    int elems[60], old_prios[60], new_prios[60];
+    PQElement elem_ptrs[60];
+    PQElementPriority old_prio_ptrs[60], new_prio_ptrs[60];
+
+    for (int i = 0; i < 200; i++) {
+        int elem = i % 50;
+        int prio = i % 100 % 7;
+        pqInsert(pq, &elem, &prio);
+        for (int j = 0; j < 4; j++) {
+            ASSERT_TEST(pqInsert(batch_pqs[j], &elem, &prio) == PQ_SUCCESS, destroy);
+        }
+    }
+
+    // every element has two entries with each of its two priorities, and some changes repeat an entry
+    for (int i = 0; i < 60; i++) {
+        elems[i] = (i * 13) % 50;
+        old_prios[i] = (elems[i] + 50 * (i % 2)) % 7;
+        new_prios[i] = i % 5 - 1;
+        elem_ptrs[i] = &elems[i];
+        old_prio_ptrs[i] = &old_prios[i];
+        new_prio_ptrs[i] = &new_prios[i];
+        ASSERT_TEST(pqChangePriority(pq, &elems[i], &old_prios[i], &new_prios[i]) == PQ_SUCCESS, destroy);
+    }
+
+    int missing = 50;
+    elem_ptrs[59] = &missing;
+    for (int j = 0; j < 4; j++) {
+        ASSERT_TEST(pqChangePriorityBatch(batch_pqs[j], elem_ptrs, old_prio_ptrs, new_prio_ptrs, 60) ==
+                    PQ_ELEMENT_DOES_NOT_EXISTS, destroy);
+        ASSERT_TEST(pqGetSize(batch_pqs[j]) == 200 && *(int *) pqGetFirst(batch_pqs[j]) == 6, destroy);
+    }
+    elem_ptrs[59] = &elems[59];
+    for (int j = 0; j < 4; j++) {
+        ASSERT_TEST(pqChangePriorityBatch(batch_pqs[j], elem_ptrs, old_prio_ptrs, NULL, 60) == PQ_NULL_ARGUMENT,
+                    destroy);
+        ASSERT_TEST(pqChangePriorityBatch(batch_pqs[j], elem_ptrs, old_prio_ptrs, new_prio_ptrs, 60) == PQ_SUCCESS,
+                    destroy);
+    }
+
+    for (int j = 0; j < 4; j++) {
+        int *batch_elem = pqGetFirst(batch_pqs[j]);
+        PQ_FOREACH(int *, elem, pq) {
+            ASSERT_TEST(batch_elem != NULL && *batch_elem == *elem, destroy);
+            batch_elem = pqGetNext(batch_pqs[j]);
+        }
+        ASSERT_TEST(batch_elem == NULL, destroy);
+    }
+
+    destroy:
+    pqDestroy(pq);
+    for (int j = 0; j < 4; j++) {
+        pqDestroy(batch_pqs[j]);
+    }
+    return result;
+}
+
+bool testPQChangePriorityBatchWalksOnce() {
+    bool result = true;
+    PQEngine engines[] = {PQ_ENGINE_SORTED_LIST, PQ_ENGINE_HEAP, PQ_ENGINE_PAIRING};
+    PQ pq = NULL;
+    int elems[100], old_prios[100], new_prios[100];
+    PQElement elem_ptrs[100];
+    PQElementPriority old_prio_ptrs[100], new_prio_ptrs[100];
+
+    for (int e = 0; e < 3; e++) {
+        PQOptions options = {.engine = engines[e]};
+        pq = pqCreateWithOptions(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric, freeIntGeneric,
+                                 compareIntsGeneric, &options);
+        ASSERT_TEST(pq != NULL, destroy);
+        for (int i = 0; i < 1000; i++) {
+            ASSERT_TEST(pqInsert(pq, &i, &i) == PQ_SUCCESS, destroy);
+        }
+        for (int i = 0; i < 100; i++) {
+            elems[i] = i * 10;
+            old_prios[i] = i * 10;
+            new_prios[i] = -i;
+            elem_ptrs[i] = &elems[i];
+            old_prio_ptrs[i] = &old_prios[i];
+            new_prio_ptrs[i] = &new_prios[i];
+        }
+
+#ifdef PQ_ENABLE_STATS
+        PQStats before, after;
+        pqGetStats(pq, &before);
+#endif
+        ASSERT_TEST(pqChangePriorityBatch(pq, elem_ptrs, old_prio_ptrs, new_prio_ptrs, 100) == PQ_SUCCESS, destroy);
+#ifdef PQ_ENABLE_STATS
+        // one walk over the 1000 entries and the reorder, instead of a walk for every change
+        pqGetStats(pq, &after);
+        ASSERT_TEST(after.nodes_visited - before.nodes_visited < 3 * 1000, destroy);
+#endif
+
+        int expected = 999;
+        for (int i = 0; i < 900; i++) {
+            if (expected % 10 == 0) {
+                expected--;
+            }
+            int *elem = pqGetFirst(pq);
+            ASSERT_TEST(elem != NULL && *elem == expected, destroy);
+            pqRemove(pq);
+            expected--;
+        }
+        for (int i = 0; i < 100; i++) {
+            ASSERT_TEST(*(int *) pqGetFirst(pq) == i * 10 && pqRemove(pq) == PQ_SUCCESS, destroy);
+        }
+        pqDestroy(pq);
+        pq = NULL;
+    }
+
+    destroy:
+    pqDestroy(pq);
+    return result;
+}
+
+bool testPQLazyRemovalMatchesImmediate() {
+    bool result = true;
+    PQOptions lazy_options[3] = {{.max_removed_percent = 50},
+                                 {.engine = PQ_ENGINE_HEAP, .max_removed_percent = 100},
+                                 {.engine = PQ_ENGINE_PAIRING, .hash_element = hashIntGeneric,
+                                  .max_removed_percent = 20}};
+    PQ pq = createPQ();
+    PQ lazy_pqs[3] = {NULL, NULL, NULL};
+    PQ lazy_copy = NULL;
+    PQHandle handles[3][200];
+    for (int j = 0; j < 3; j++) {
+        lazy_pqs[j] = pqCreateWithOptions(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric,
+                                          freeIntGeneric, compareIntsGeneric, &lazy_options[j]);
+        ASSERT_TEST(lazy_pqs[j] != NULL, destroy);
+    }
+
+    for (int i = 0; i < 200; i++) {
+        int prio = rand() % 25;
+        pqInsert(pq, &i, &prio);
+        for (int j = 0; j < 3; j++) {
+            ASSERT_TEST(pqInsertWithHandle(lazy_pqs[j], &i, &prio, &handles[j][i]) == PQ_SUCCESS, destroy);
+        }
+    }
+
+    // cancel most of the entries, through the elements and through the handles
+    for (int i = 0; i < 200; i++) {
+        if (i % 5 == 0) {
+            continue;
+        }
+        ASSERT_TEST(pqRemoveElement(pq, &i) == PQ_SUCCESS, destroy);
+        for (int j = 0; j < 3; j++) {
+            if (i % 2 == 0) {
+                ASSERT_TEST(pqRemoveByHandle(lazy_pqs[j], handles[j][i]) == PQ_SUCCESS, destroy);
+            } else {
+                ASSERT_TEST(pqRemoveElement(lazy_pqs[j], &i) == PQ_SUCCESS, destroy);
+            }
+            ASSERT_TEST(pqGetSize(lazy_pqs[j]) == pqGetSize(pq) && !pqContains(lazy_pqs[j], &i), destroy);
+            ASSERT_TEST(pqRemoveElement(lazy_pqs[j], &i) == PQ_ELEMENT_DOES_NOT_EXISTS, destroy);
+        }
+        if (i == 101) {
+            lazy_copy = pqCopy(lazy_pqs[1]);
+            ASSERT_TEST(lazy_copy != NULL && pqGetSize(lazy_copy) == pqGetSize(pq), destroy);
+        }
+    }
+
+    int new_prio = 30;
+    int old_prio;
+    for (old_prio = 0; old_prio < 25; old_prio++) {
+        if (pqChangePriority(pq, &(int){195}, &old_prio, &new_prio) == PQ_SUCCESS) {
+            break;
+        }
+    }
+    for (int j = 0; j < 3; j++) {
+        ASSERT_TEST(pqChangePriority(lazy_pqs[j], &(int){195}, &old_prio, &new_prio) == PQ_SUCCESS, destroy);
+        int *lazy_elem = pqGetFirst(lazy_pqs[j]);
+        PQ_FOREACH(int *, elem, pq) {
+            ASSERT_TEST(lazy_elem != NULL && *lazy_elem == *elem, destroy);
+            lazy_elem = pqGetNext(lazy_pqs[j]);
+        }
+        ASSERT_TEST(lazy_elem == NULL, destroy);
+    }
+
+    // the copy was taken in the middle, and still has the entries removed after it
+    ASSERT_TEST(pqContains(lazy_copy, &(int){199}) && pqRemove(lazy_copy) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqGetSize(lazy_copy) > pqGetSize(pq) && pqShrinkToFit(lazy_copy) == PQ_SUCCESS, destroy);
+
+    while (pqGetSize(pq) > 0) {
+        for (int j = 0; j < 3; j++) {
+            int *elem = pqPop(lazy_pqs[j], NULL);
+            bool is_same = elem != NULL && *elem == *(int *) pqGetFirst(pq);
+            free(elem);
+            ASSERT_TEST(is_same, destroy);
+        }
+        pqRemove(pq);
+    }
+    for (int j = 0; j < 3; j++) {
+        ASSERT_TEST(pqGetSize(lazy_pqs[j]) == 0 && pqGetFirst(lazy_pqs[j]) == NULL, destroy);
+    }
+
+    destroy:
+    pqDestroy(pq);
+    pqDestroy(lazy_copy);
+    for (int j = 0; j < 3; j++) {
+        pqDestroy(lazy_pqs[j]);
+    }
+    return result;
+}
+
+bool testPQShrinkToFitKeepsIterators() {
+    bool result = true;
+    PQOptions lazy_options = {.engine = PQ_ENGINE_HEAP, .max_removed_percent = 100};
+    PQ pq = pqCreateWithOptions(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric,
+                                freeIntGeneric, compareIntsGeneric, &lazy_options);
+    PQIterator iterator;
+    ASSERT_TEST(pq != NULL, destroy);
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TEST(pqInsert(pq, &i, &i) == PQ_SUCCESS, destroy);
+    }
+    for (int i = 0; i < 50; i++) {
+        pqRemove(pq);
+    }
+
+    // without removed entries to free, shrinking only frees memory, and the iterator goes on
+    int *elem = pqIterBegin(pq, &iterator);
+    ASSERT_TEST(elem != NULL && *elem == 49 && pqShrinkToFit(pq) == PQ_SUCCESS, destroy);
+    int expected = 48;
+    for (elem = pqIterNext(&iterator); elem != NULL; elem = pqIterNext(&iterator)) {
+        ASSERT_TEST(*elem == expected, destroy);
+        expected--;
+    }
+    ASSERT_TEST(expected == -1, destroy);
+    pqIterEnd(&iterator);
+
+    // freeing the removed entries ends the iterator
+    ASSERT_TEST(pqRemoveElement(pq, &(int){10}) == PQ_SUCCESS, destroy);
+    elem = pqIterBegin(pq, &iterator);
+    ASSERT_TEST(elem != NULL && *elem == 49 && pqShrinkToFit(pq) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqIterNext(&iterator) == NULL && pqGetSize(pq) == 49, destroy);
+    pqIterEnd(&iterator);
+
+    // the internal iterator goes on over the freed entries
+    ASSERT_TEST(pqRemoveElement(pq, &(int){47}) == PQ_SUCCESS && *(int *) pqGetFirst(pq) == 49, destroy);
+    ASSERT_TEST(pqShrinkToFit(pq) == PQ_SUCCESS && *(int *) pqGetNext(pq) == 48, destroy);
+    ASSERT_TEST(*(int *) pqGetNext(pq) == 46, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    return result;
+}
+
+bool testPQStatsCountOperations() {
+    bool result = true;
+    PQ pq = createHashedPQ(PQ_ENGINE_HEAP);
+    PQ copy = NULL;
+    PQStats stats;
+    ASSERT_TEST(pqGetStats(NULL, &stats) == PQ_NULL_ARGUMENT && pqGetStats(pq, NULL) == PQ_NULL_ARGUMENT, destroy);
+
+    for (int i = 0; i < 100; i++) {
+        int prio = i % 10;
+        pqInsert(pq, &i, &prio);
+    }
+    int old_prio = 5, new_prio = 20;
+    ASSERT_TEST(pqChangePriority(pq, &(int){5}, &old_prio, &new_prio) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqRemoveElement(pq, &(int){7}) == PQ_SUCCESS && pqRemove(pq) == PQ_SUCCESS, destroy);
+    copy = pqCopy(pq);
+
+#ifdef PQ_ENABLE_STATS
+    ASSERT_TEST(pqGetStats(pq, &stats) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(stats.max_size == 100 && stats.copies == 201 && stats.frees == 5, destroy);
+    ASSERT_TEST(stats.comparisons > 0 && stats.equality_checks >= 2 && stats.nodes_visited > 0, destroy);
+
+    unsigned long operation_counts[PQ_STATS_OPERATION_COUNT] = {0};
+    for (int operation = 0; operation < PQ_STATS_OPERATION_COUNT; operation++) {
+        for (int i = 0; i < PQ_STATS_LATENCY_BUCKETS; i++) {
+            operation_counts[operation] += stats.latency_histogram[operation][i];
+        }
+    }
+    ASSERT_TEST(operation_counts[PQ_STATS_INSERT] == 100 && operation_counts[PQ_STATS_REMOVE] == 1, destroy);
+    ASSERT_TEST(operation_counts[PQ_STATS_CHANGE_PRIORITY] == 1 && operation_counts[PQ_STATS_REMOVE_ELEMENT] == 1,
+                destroy);
+
+    ASSERT_TEST(pqGetStats(copy, &stats) == PQ_SUCCESS && stats.max_size == 0 && stats.copies == 0, destroy);
+#else
+    ASSERT_TEST(pqGetStats(pq, &stats) == PQ_ERROR && pqGetStats(copy, &stats) == PQ_ERROR, destroy);
+#endif
+
+    destroy:
+    pqDestroy(pq);
+    pqDestroy(copy);
+    return result;
+}
+
+bool testPQGetFirstAndRemoveDrainIsFast() {
+    bool result = true;
+    PQEngine engines[] = {PQ_ENGINE_SORTED_LIST, PQ_ENGINE_HEAP, PQ_ENGINE_PAIRING};
+    PQ list_pq = NULL;
+    PQ pq = NULL;
+
+    for (int engine = 0; engine < 3; engine++) {
+        PQOptions options = {.engine = engines[engine]};
+        list_pq = createPQ();
+        pq = pqCreateWithOptions(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric, freeIntGeneric,
+                                 compareIntsCounting, &options);
+        ASSERT_TEST(list_pq != NULL && pq != NULL, destroy);
+        for (int i = 0; i < 2000; i++) {
+            int prio = rand() % 500;
+            pqInsert(list_pq, &i, &prio);
+            pqInsert(pq, &i, &prio);
+        }
+
+        // the iteration goes on after the first element
+        ASSERT_TEST(*(int *) pqGetFirst(pq) == *(int *) pqGetFirst(list_pq), destroy);
+        ASSERT_TEST(*(int *) pqGetNext(pq) == *(int *) pqGetNext(list_pq), destroy);
+
+        // reading the first element before every remove keeps the drain O(n log n)
+        compared_count = 0;
+        while (pqGetSize(list_pq) > 0) {
+            ASSERT_TEST(*(int *) pqGetFirst(pq) == *(int *) pqGetFirst(list_pq), destroy);
+            ASSERT_TEST(pqRemove(pq) == PQ_SUCCESS && pqRemove(list_pq) == PQ_SUCCESS, destroy);
+        }
+        ASSERT_TEST(pqGetFirst(pq) == NULL && compared_count < 100 * 2000, destroy);
+
+        pqDestroy(list_pq);
+        pqDestroy(pq);
+        list_pq = NULL;
+        pq = NULL;
+    }
+
+    destroy:
+    pqDestroy(list_pq);
+    pqDestroy(pq);
+    return result;
+}
+
+bool testIPQMatchesPriorityQueue() {
+    bool result = true;
+    PQ pq = createPQ();
+    IntPriorityQueue ipq = ipqCreate(copyIntGeneric, freeIntGeneric, equalIntsGeneric, -5, 50);
+    IntPriorityQueue top_ipq = ipqCreate(copyIntGeneric, freeIntGeneric, equalIntsGeneric, INT_MAX - 1, INT_MAX);
+    int *popped = NULL;
+    ASSERT_TEST(ipqCreate(copyIntGeneric, freeIntGeneric, equalIntsGeneric, 5, 4) == NULL, destroy);
+    ASSERT_TEST(ipqCreate(copyIntGeneric, freeIntGeneric, equalIntsGeneric, INT_MIN, INT_MAX) == NULL, destroy);
+    ASSERT_TEST(ipq != NULL && ipqGetSize(ipq) == 0 && ipqGetFirst(ipq, NULL) == NULL, destroy);
+    ASSERT_TEST(ipqGetSize(NULL) == -1 && ipqRemove(ipq) == PQ_ELEMENT_DOES_NOT_EXISTS, destroy);
+
+    for (int i = 0; i < 200; i++) {
+        int prio = rand() % 40;
+        ASSERT_TEST(pqInsert(pq, &i, &prio) == PQ_SUCCESS, destroy);
+        ASSERT_TEST(ipqInsert(ipq, &i, prio) == PQ_SUCCESS, destroy);
+    }
+    int out_of_range = 51;
+    ASSERT_TEST(ipqInsert(ipq, &out_of_range, out_of_range) == PQ_ERROR, destroy);
+    ASSERT_TEST(ipqInsert(NULL, &out_of_range, 0) == PQ_NULL_ARGUMENT, destroy);
+    ASSERT_TEST(ipqInsert(ipq, &out_of_range, INT_MAX) == PQ_ERROR, destroy);
+    ASSERT_TEST(ipqChangePriority(ipq, &out_of_range, INT_MAX, 0) == PQ_ELEMENT_DOES_NOT_EXISTS, destroy);
+
+    for (int i = 0; i < 200; i += 7) {
+        int new_prio = i % 2 == 0 ? 45 : -5;
+        int old_prio;
+        for (old_prio = 0; old_prio < 40; old_prio++) {
+            if (pqChangePriority(pq, &i, &old_prio, &new_prio) == PQ_SUCCESS) {
+                break;
+            }
+        }
+        ASSERT_TEST(ipqChangePriority(ipq, &i, old_prio, 51) == PQ_ERROR, destroy);
+        ASSERT_TEST(ipqChangePriority(ipq, &i, old_prio, new_prio) == PQ_SUCCESS, destroy);
+        ASSERT_TEST(ipqChangePriority(ipq, &i, 46, new_prio) == PQ_ELEMENT_DOES_NOT_EXISTS, destroy);
+    }
+    ASSERT_TEST(ipqGetSize(ipq) == pqGetSize(pq) && !ipqContains(ipq, &(int){200}), destroy);
+
+    // pop half and insert lower priorities, the way a monotone queue is used
+    for (int i = 0; i < 100; i++) {
+        int prio;
+        popped = ipqPop(ipq, &prio);
+        ASSERT_TEST(popped != NULL && *popped == *(int *) pqGetFirst(pq), destroy);
+        pqRemove(pq);
+        int new_prio = prio > 0 ? prio - 1 : prio;
+        ASSERT_TEST(pqInsert(pq, popped, &new_prio) == PQ_SUCCESS, destroy);
+        ASSERT_TEST(ipqInsert(ipq, popped, new_prio) == PQ_SUCCESS, destroy);
+        free(popped);
+        popped = NULL;
+    }
+
+    while (pqGetSize(pq) > 0) {
+        ASSERT_TEST(*(int *) ipqGetFirst(ipq, NULL) == *(int *) pqGetFirst(pq), destroy);
+        ASSERT_TEST(ipqRemove(ipq) == PQ_SUCCESS, destroy);
+        pqRemove(pq);
+    }
+    ASSERT_TEST(ipqGetSize(ipq) == 0 && ipqPop(ipq, NULL) == NULL, destroy);
+
+    // the priorities at the ends of int are in range as well
+    ASSERT_TEST(top_ipq != NULL && ipqInsert(top_ipq, &out_of_range, INT_MAX) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(ipqInsert(top_ipq, &out_of_range, INT_MIN) == PQ_ERROR, destroy);
+    ASSERT_TEST(ipqChangePriority(top_ipq, &out_of_range, INT_MAX, INT_MAX - 1) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(ipqGetSize(top_ipq) == 1, destroy);
+
+    destroy:
+    free(popped);
+    pqDestroy(pq);
+    ipqDestroy(ipq);
+    ipqDestroy(top_ipq);
+    return result;
+}
+
+bool testPQHashIndexMatchesScan() {
+    bool result = true;
+    PQ pq = createPQ();
+    PQ hashed_list_pq = createHashedPQ(PQ_ENGINE_SORTED_LIST);
+    PQ hashed_heap_pq = createHashedPQ(PQ_ENGINE_HEAP);
+    PQ copy = NULL;
+    ASSERT_TEST(hashed_list_pq != NULL && hashed_heap_pq != NULL, destroy);
+
+    for (int i = 0; i < 400; i++) {
+        int elem = i % 60;
+        int prio = (i * 7) % 13;
+        pqInsert(pq, &elem, &prio);
+        pqInsert(hashed_list_pq, &elem, &prio);
+        pqInsert(hashed_heap_pq, &elem, &prio);
+    }
+
+    for (int elem = 0; elem < 80; elem += 3) {
+        bool contains = pqContains(pq, &elem);
+        ASSERT_TEST(pqContains(hashed_list_pq, &elem) == contains, destroy);
+        ASSERT_TEST(pqContains(hashed_heap_pq, &elem) == contains, destroy);
+
+        PriorityQueueResult remove_result = pqRemoveElement(pq, &elem);
+        ASSERT_TEST(pqRemoveElement(hashed_list_pq, &elem) == remove_result, destroy);
+        ASSERT_TEST(pqRemoveElement(hashed_heap_pq, &elem) == remove_result, destroy);
+
+        int old_prio = elem % 13;
+        int new_prio = 20 + elem;
+        PriorityQueueResult change_result = pqChangePriority(pq, &elem, &old_prio, &new_prio);
+        ASSERT_TEST(pqChangePriority(hashed_list_pq, &elem, &old_prio, &new_prio) == change_result, destroy);
+        ASSERT_TEST(pqChangePriority(hashed_heap_pq, &elem, &old_prio, &new_prio) == change_result, destroy);
+    }
+
+    copy = pqCopy(hashed_heap_pq);
+    ASSERT_TEST(copy != NULL, destroy);
+    int elem = 59;
+    ASSERT_TEST(pqContains(copy, &elem), destroy);
+
+    while (pqGetSize(pq) > 0) {
+        int first = *(int *) pqGetFirst(pq);
+        ASSERT_TEST(*(int *) pqGetFirst(hashed_list_pq) == first, destroy);
+        ASSERT_TEST(*(int *) pqGetFirst(hashed_heap_pq) == first, destroy);
+        ASSERT_TEST(*(int *) pqGetFirst(copy) == first, destroy);
+        pqRemove(pq);
+        pqRemove(hashed_list_pq);
+        pqRemove(hashed_heap_pq);
+        pqRemove(copy);
+    }
+    ASSERT_TEST(!pqContains(hashed_heap_pq, &elem) && !pqContains(copy, &elem), destroy);
+
+    destroy:
+    pqDestroy(copy);
+    pqDestroy(pq);
+    pqDestroy(hashed_list_pq);
+    pqDestroy(hashed_heap_pq);
+    return result;
+}
+
+bool testPQHandleUpdateAndRemove() {
+    bool result = true;
+    PQ pq = createPQ();
+    PQ heap_pq = createHeapPQ(3);
+
+    PQHandle handles[10];
+    PQHandle heap_handles[10];
+    for (int i = 0; i < 10; i++) {
+        ASSERT_TEST(pqInsertWithHandle(pq, &i, &i, &handles[i]) == PQ_SUCCESS, destroy);
+        ASSERT_TEST(pqInsertWithHandle(heap_pq, &i, &i, &heap_handles[i]) == PQ_SUCCESS, destroy);
+    }
+    ASSERT_TEST(pqInsertWithHandle(pq, handles, NULL, handles) == PQ_NULL_ARGUMENT, destroy);
+
+    pqGetFirst(pq);
+    int top_prio = 100;
+    ASSERT_TEST(pqUpdatePriorityByHandle(pq, handles[3], &top_prio) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqUpdatePriorityByHandle(heap_pq, heap_handles[3], &top_prio) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqGetNext(pq) == NULL, destroy);
+    ASSERT_TEST(*(int *) pqGetFirst(pq) == 3 && *(int *) pqGetFirst(heap_pq) == 3, destroy);
+    ASSERT_TEST(*(int *) pqGetNext(pq) == 9 && *(int *) pqGetNext(heap_pq) == 9, destroy);
+
+    // the same priority again puts the entry after the older entries with that priority
+    ASSERT_TEST(pqUpdatePriorityByHandle(pq, handles[9], &top_prio) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqUpdatePriorityByHandle(heap_pq, heap_handles[9], &top_prio) == PQ_SUCCESS, destroy);
+    int low_prio = -1;
+    ASSERT_TEST(pqUpdatePriorityByHandle(pq, handles[8], &low_prio) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqUpdatePriorityByHandle(heap_pq, heap_handles[8], &low_prio) == PQ_SUCCESS, destroy);
+
+    ASSERT_TEST(pqRemoveByHandle(pq, handles[5]) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqRemoveByHandle(heap_pq, heap_handles[5]) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqGetSize(pq) == 9 && pqGetSize(heap_pq) == 9, destroy);
+
+    int expected[] = {3, 9, 7, 6, 4, 2, 1, 0, 8};
+    for (int i = 0; i < 9; i++) {
+        ASSERT_TEST(*(int *) pqGetFirst(pq) == expected[i], destroy);
+        ASSERT_TEST(*(int *) pqGetFirst(heap_pq) == expected[i], destroy);
+        pqRemove(pq);
+        pqRemove(heap_pq);
+    }
+
+    destroy:
+    pqDestroy(pq);
+    pqDestroy(heap_pq);
+    return result;
+}
+
+bool testPQNodePoolReuseAndShrink() {
+    bool result = true;
+    PQOptions options = {.engine = PQ_ENGINE_HEAP, .initial_capacity = 100};
+    PQ pq = pqCreateWithOptions(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric,
+                                freeIntGeneric, compareIntsGeneric, &options);
+    ASSERT_TEST(pq != NULL, destroy);
+    ASSERT_TEST(pqShrinkToFit(NULL) == PQ_NULL_ARGUMENT, destroy);
+
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 3000; i++) {
+            ASSERT_TEST(pqInsert(pq, &i, &i) == PQ_SUCCESS, destroy);
+        }
+        for (int i = 0; i < 2990; i++) {
+            ASSERT_TEST(pqRemove(pq) == PQ_SUCCESS, destroy);
+        }
+        ASSERT_TEST(pqShrinkToFit(pq) == PQ_SUCCESS, destroy);
+        ASSERT_TEST(pqGetSize(pq) == 10 * (round + 1), destroy);
+    }
+
+    // every round left the same 10 lowest priorities, so each one is there 3 times
+    ASSERT_TEST(*(int *) pqGetFirst(pq) == 9, destroy);
+    ASSERT_TEST(pqShrinkToFit(pq) == PQ_SUCCESS, destroy);
+    for (int i = 1; i < 30; i++) {
+        int *elem = pqGetNext(pq);
+        ASSERT_TEST(elem != NULL && *elem == 9 - i / 3, destroy);
+    }
+
+    pqClear(pq);
+    ASSERT_TEST(pqShrinkToFit(pq) == PQ_SUCCESS, destroy);
+    int elem = 0;
+    ASSERT_TEST(pqInsert(pq, &elem, &elem) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqGetSize(pq) == 1, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    return result;
+}
+
+bool testPQInsertTakeAndPopTake() {
+    bool result = true;
+    PQ pq = createHashedPQ(PQ_ENGINE_HEAP);
+
+    for (int i = 0; i < 20; i++) {
+        int *elem = randInt();
+        int *prio = randInt();
+        *elem = i;
+        *prio = i % 5;
+        ASSERT_TEST(pqInsertTake(pq, elem, prio) == PQ_SUCCESS, destroy);
+    }
+    ASSERT_TEST(pqInsertTake(pq, NULL, NULL) == PQ_NULL_ARGUMENT, destroy);
+
+    int elem = 14;
+    ASSERT_TEST(pqContains(pq, &elem), destroy);
+
+    int *popped_elem = NULL;
+    int *popped_prio = NULL;
+    for (int i = 0; i < 20; i++) {
+        ASSERT_TEST(pqPopTake(pq, (PQElement *) &popped_elem, (PQElementPriority *) &popped_prio) == PQ_SUCCESS,
+                    destroy);
+        ASSERT_TEST(*popped_prio == 4 - i / 4 && *popped_elem == 4 - i / 4 + (i % 4) * 5, destroyPopped);
+        free(popped_elem);
+        free(popped_prio);
+    }
+    ASSERT_TEST(pqPopTake(pq, (PQElement *) &popped_elem, (PQElementPriority *) &popped_prio) ==
+                PQ_ELEMENT_DOES_NOT_EXISTS, destroy);
+    ASSERT_TEST(!pqContains(pq, &elem), destroy);
+    goto destroy;
+
+    destroyPopped:
+    free(popped_elem);
+    free(popped_prio);
+    destroy:
+    pqDestroy(pq);
+    return result;
+}
+
+bool testPQPopAndPopN() {
+    bool result = true;
+    PQ pq = createPQ();
+    int *popped[8] = {NULL};
+    int *popped_prios[8] = {NULL};
+    int popped_count = 0;
+
+    ASSERT_TEST(pqPop(pq, NULL) == NULL, destroy);
+    ASSERT_TEST(pqPopN(NULL, (PQElement *) popped, NULL, 1) == -1, destroy);
+
+    for (int i = 0; i < 10; i++) {
+        pqInsert(pq, &i, &i);
+    }
+
+    int *prio = NULL;
+    int *elem = pqPop(pq, (PQElementPriority *) &prio);
+    ASSERT_TEST(elem != NULL && *elem == 9 && *prio == 9, destroyPopped);
+    free(elem);
+    free(prio);
+    elem = pqPop(pq, NULL);
+    ASSERT_TEST(elem != NULL && *elem == 8, destroyPopped);
+    free(elem);
+
+    popped_count = pqPopN(pq, (PQElement *) popped, NULL, 3);
+    ASSERT_TEST(popped_count == 3 && *popped[0] == 7 && *popped[2] == 5, destroyPopped);
+    for (int i = 0; i < popped_count; i++) {
+        free(popped[i]);
+    }
+
+    popped_count = pqPopN(pq, (PQElement *) popped, (PQElementPriority *) popped_prios, 8);
+    ASSERT_TEST(popped_count == 5 && *popped[0] == 4 && *popped_prios[4] == 0, destroyPopped);
+    ASSERT_TEST(pqGetSize(pq) == 0, destroyPopped);
+
+    destroyPopped:
+    for (int i = 0; i < popped_count; i++) {
+        free(popped[i]);
+        free(popped_prios[i]);
+    }
+    destroy:
+    pqDestroy(pq);
+    return result;
+}
+
+bool testPQInsertBatchMatchesInsert() {
+    bool result = true;
+    PQ pq = createPQ();
+    PQ batch_pq = createPQ();
+    PQ batch_heap_pq = createHashedPQ(PQ_ENGINE_HEAP);
+
+    int elems[300];
+    int prios[300];
+    PQElement elem_ptrs[300];
+    PQElementPriority prio_ptrs[300];
+    for (int i = 0; i < 300; i++) {
+        elems[i] = i;
+        prios[i] = rand() % 30;
+        elem_ptrs[i] = &elems[i];
+        prio_ptrs[i] = &prios[i];
+    }
+
+    // a small batch into an empty queue, a big one after it, and a small one into a big queue
+    int batch_starts[] = {0, 20, 290, 300};
+    for (int batch = 0; batch < 3; batch++) {
+        int start = batch_starts[batch];
+        int count = batch_starts[batch + 1] - start;
+        for (int i = start; i < start + count; i++) {
+            pqInsert(pq, &elems[i], &prios[i]);
+        }
+        ASSERT_TEST(pqInsertBatch(batch_pq, elem_ptrs + start, prio_ptrs + start, count) == PQ_SUCCESS, destroy);
+        ASSERT_TEST(pqInsertBatch(batch_heap_pq, elem_ptrs + start, prio_ptrs + start, count) == PQ_SUCCESS,
+                    destroy);
+    }
+    ASSERT_TEST(pqInsertBatch(batch_pq, elem_ptrs, prio_ptrs, -1) == PQ_ERROR, destroy);
+    ASSERT_TEST(pqGetSize(batch_pq) == 300 && pqGetSize(batch_heap_pq) == 300, destroy);
+    ASSERT_TEST(pqRemoveElement(batch_heap_pq, &elems[295]) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqRemoveElement(pq, &elems[295]) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqRemoveElement(batch_pq, &elems[295]) == PQ_SUCCESS, destroy);
+
+    int *batch_elem = pqGetFirst(batch_pq);
+    PQ_FOREACH(int *, elem, pq) {
+        ASSERT_TEST(batch_elem != NULL && *batch_elem == *elem, destroy);
+        ASSERT_TEST(*(int *) pqGetFirst(batch_heap_pq) == *elem, destroy);
+        pqRemove(batch_heap_pq);
+        batch_elem = pqGetNext(batch_pq);
+    }
+
+    destroy:
+    pqDestroy(pq);
+    pqDestroy(batch_pq);
+    pqDestroy(batch_heap_pq);
+    return result;
+}
+
+bool testPQBoundedQueueEvictsLowest() {
+    bool result = true;
+    PQEngine engines[] = {PQ_ENGINE_SORTED_LIST, PQ_ENGINE_HEAP};
+    PQOptions pairing_options = {.engine = PQ_ENGINE_PAIRING, .capacity = 5, .evict_element = countEvictedGeneric};
+    PQ pq = NULL;
+    // the pairing heap keeps no order among its last entries
+    PQ pairing_pq = pqCreateWithOptions(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric,
+                                        freeIntGeneric, compareIntsGeneric, &pairing_options);
+    ASSERT_TEST(pairing_pq == NULL, destroy);
+
+    for (int e = 0; e < 2; e++) {
+        PQOptions options = {.engine = engines[e], .capacity = 5, .evict_element = countEvictedGeneric};
+        pq = pqCreateWithOptions(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric,
+                                 freeIntGeneric, compareIntsGeneric, &options);
+        ASSERT_TEST(pq != NULL, destroy);
+
+        evicted_count = 0;
+        evicted_sum = 0;
+        int prios[] = {5, 1, 9, 3, 7, 2, 8, 6, 1, 9};
+        for (int i = 0; i < 10; i++) {
+            PQHandle handle;
+            ASSERT_TEST(pqInsertWithHandle(pq, &i, &prios[i], &handle) == PQ_SUCCESS, destroy);
+            ASSERT_TEST(pqGetSize(pq) <= 5, destroy);
+        }
+
+        // the kept entries are the priorities 9, 9, 8, 7, 6
+        ASSERT_TEST(evicted_count == 5 && evicted_sum == 1 + 3 + 0 + 5 + 8, destroy);
+        int expected[] = {2, 9, 6, 4, 7};
+        for (int i = 0; i < 5; i++) {
+            ASSERT_TEST(*(int *) pqGetFirst(pq) == expected[i], destroy);
+            pqRemove(pq);
+        }
+
+        PQElement elem_ptrs[10];
+        PQElementPriority prio_ptrs[10];
+        for (int i = 0; i < 10; i++) {
+            elem_ptrs[i] = &prios[i];
+            prio_ptrs[i] = &prios[i];
+        }
+        ASSERT_TEST(pqInsertBatch(pq, elem_ptrs, prio_ptrs, 10) == PQ_SUCCESS, destroy);
+        ASSERT_TEST(pqGetSize(pq) == 5 && *(int *) pqGetFirst(pq) == 9, destroy);
+        pqDestroy(pq);
+        pq = NULL;
+    }
+
+    destroy:
+    pqDestroy(pq);
+    pqDestroy(pairing_pq);
+    return result;
+}
+
+bool testPQBoundedHeapMatchesSortedList() {
+    bool result = true;
+    PQOptions list_options = {.capacity = 100, .evict_element = countEvictedGeneric};
+    PQOptions heap_options = {.engine = PQ_ENGINE_HEAP, .capacity = 100, .evict_element = countEvictedGeneric,
+                              .max_removed_percent = 20};
+    PQ list_pq = pqCreateWithOptions(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric,
+                                     freeIntGeneric, compareIntsGeneric, &list_options);
+    PQ heap_pq = pqCreateWithOptions(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric,
+                                     freeIntGeneric, compareIntsGeneric, &heap_options);
+    PQ heap_copy = NULL;
+    ASSERT_TEST(list_pq != NULL && heap_pq != NULL, destroy);
+
+    srand(9);
+    int list_evicted_count = 0, list_evicted_sum = 0;
+    int heap_evicted_count = 0, heap_evicted_sum = 0;
+    for (int i = 0; i < 3000; i++) {
+        int element = rand() % 500;
+        int priority = rand() % 1000;
+        int new_priority = rand() % 1000;
+        PQ queues[] = {list_pq, heap_pq};
+        int *counts[] = {&list_evicted_count, &heap_evicted_count};
+        int *sums[] = {&list_evicted_sum, &heap_evicted_sum};
+        PriorityQueueResult results[2];
+        for (int q = 0; q < 2; q++) {
+            evicted_count = 0;
+            evicted_sum = 0;
+            if (i % 5 == 3) {
+                results[q] = pqChangePriority(queues[q], &element, &priority, &new_priority);
+            } else if (i % 5 == 4) {
+                results[q] = pqRemoveElement(queues[q], &element);
+            } else {
+                results[q] = pqInsert(queues[q], &element, &priority);
+            }
+            *counts[q] += evicted_count;
+            *sums[q] += evicted_sum;
+        }
+        ASSERT_TEST(results[0] == results[1] && pqGetSize(list_pq) == pqGetSize(heap_pq), destroy);
+    }
+    ASSERT_TEST(list_evicted_count > 0 && list_evicted_count == heap_evicted_count, destroy);
+    ASSERT_TEST(list_evicted_sum == heap_evicted_sum, destroy);
+
+    // a copy evicts the same way, and the entries stay in the same order
+    heap_copy = pqCopy(heap_pq);
+    ASSERT_TEST(heap_copy != NULL && pqGetSize(heap_copy) == pqGetSize(heap_pq), destroy);
+    for (int top = 1000; top < 1100; top++) {
+        ASSERT_TEST(pqInsert(heap_copy, &top, &top) == PQ_SUCCESS && pqGetSize(heap_copy) <= 100, destroy);
+    }
+    for (int top = 1099; top >= 1000; top--) {
+        ASSERT_TEST(*(int *) pqGetFirst(heap_copy) == top && pqRemove(heap_copy) == PQ_SUCCESS, destroy);
+    }
+    while (pqGetSize(list_pq) > 0) {
+        ASSERT_TEST(*(int *) pqGetFirst(list_pq) == *(int *) pqGetFirst(heap_pq), destroy);
+        ASSERT_TEST(pqRemove(list_pq) == PQ_SUCCESS && pqRemove(heap_pq) == PQ_SUCCESS, destroy);
+    }
+    ASSERT_TEST(pqGetSize(heap_pq) == 0, destroy);
+
+#ifdef PQ_ENABLE_STATS
+    // an insert into a full heap finds the entry to evict at the root of the second heap
+    PQStats before, after;
+    ASSERT_TEST(pqClear(heap_pq) == PQ_SUCCESS, destroy);
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TEST(pqInsert(heap_pq, &i, &i) == PQ_SUCCESS, destroy);
+    }
+    pqGetStats(heap_pq, &before);
+    for (int i = 100; i < 1100; i++) {
+        ASSERT_TEST(pqInsert(heap_pq, &i, &i) == PQ_SUCCESS, destroy);
+    }
+    pqGetStats(heap_pq, &after);
+    ASSERT_TEST(pqGetSize(heap_pq) == 100 && after.nodes_visited - before.nodes_visited < 1000 * 30, destroy);
+#endif
+
+    destroy:
+    pqDestroy(list_pq);
+    pqDestroy(heap_pq);
+    pqDestroy(heap_copy);
+    return result;
+}
+
+bool testPQBoundedQueueRejects() {
+    bool result = true;
+    PQOptions options = {.capacity = 2, .overflow_policy = PQ_OVERFLOW_REJECT};
+    PQOptions pairing_options = {.engine = PQ_ENGINE_PAIRING, .capacity = 2, .overflow_policy = PQ_OVERFLOW_REJECT};
+    PQ pq = pqCreateWithOptions(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric,
+                                freeIntGeneric, compareIntsGeneric, &options);
+    PQ pairing_pq = pqCreateWithOptions(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric,
+                                        freeIntGeneric, compareIntsGeneric, &pairing_options);
+    int *elem = NULL;
+    ASSERT_TEST(pq != NULL && pairing_pq != NULL, destroy);
+
+    int values[] = {1, 2, 3};
+    ASSERT_TEST(pqInsert(pairing_pq, &values[0], &values[0]) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqInsert(pairing_pq, &values[1], &values[1]) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqInsert(pairing_pq, &values[2], &values[2]) == PQ_QUEUE_FULL, destroy);
+
+    ASSERT_TEST(pqInsert(pq, &values[0], &values[0]) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqInsert(pq, &values[1], &values[1]) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqInsert(pq, &values[2], &values[2]) == PQ_QUEUE_FULL, destroy);
+
+    elem = randInt();
+    ASSERT_TEST(pqInsertTake(pq, elem, elem) == PQ_QUEUE_FULL, destroy);
+    ASSERT_TEST(pqGetSize(pq) == 2 && *(int *) pqGetFirst(pq) == 2, destroy);
+
+    pqRemove(pq);
+    ASSERT_TEST(pqInsert(pq, &values[2], &values[2]) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(*(int *) pqGetFirst(pq) == 3, destroy);
+
+    destroy:
+    free(elem);
+    pqDestroy(pq);
+    pqDestroy(pairing_pq);
+    return result;
+}
+
+bool testPQIteratorsAreIndependent() {
+    bool result = true;
+    PQ pq = createPQ();
+    PQ heap_pq = createHeapPQ(3);
+    int values[] = {4, 8, 1, 8, 6};
+    for (int i = 0; i < 5; i++) {
+        pqInsert(pq, &values[i], &values[i]);
+        pqInsert(heap_pq, &values[i], &values[i]);
+    }
+
+    // two nested iterators and the internal one, scanning the same queues at once
+    int *internal = pqGetFirst(pq);
+    int pairs = 0;
+    PQIterator outer;
+    PQIterator inner;
+    for (int *first = pqIterBegin(heap_pq, &outer); first != NULL; first = pqIterNext(&outer)) {
+        int *last = NULL;
+        for (int *second = pqIterBegin(pq, &inner); second != NULL; second = pqIterNext(&inner)) {
+            ASSERT_TEST(last == NULL || *last >= *second, destroy);
+            last = second;
+            pairs++;
+        }
+        pqIterEnd(&inner);
+        ASSERT_TEST(pqIterNext(&inner) == NULL, destroy);
+    }
+    ASSERT_TEST(pairs == 25, destroy);
+    ASSERT_TEST(*internal == 8 && *(int *) pqGetNext(pq) == 8 && *(int *) pqGetNext(pq) == 6, destroy);
+
+    // a change of the queue stops the iterators that started before it
+    ASSERT_TEST(*(int *) pqIterBegin(heap_pq, &outer) == 8, destroy);
+    ASSERT_TEST(*(int *) pqIterBegin(pq, &inner) == 8, destroy);
+    pqRemove(heap_pq);
+    pqChangePriority(pq, &values[4], &values[4], &values[2]);
+    ASSERT_TEST(pqIterNext(&outer) == NULL && pqIterNext(&inner) == NULL, destroy);
+    ASSERT_TEST(pqIterBegin(NULL, &outer) == NULL && pqIterNext(NULL) == NULL, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    pqDestroy(heap_pq);
+    return result;
+}
+
+bool testPQCopySharesUntilChange() {
+    bool result = true;
+    PQ pq = createHashedPQ(PQ_ENGINE_HEAP);
+    PQ copy = NULL;
+    PQ second_copy = NULL;
+    int values[] = {3, 9, 1, 7, 5};
+    PQHandle handles[5];
+    for (int i = 0; i < 5; i++) {
+        pqInsertWithHandle(pq, &values[i], &values[i], &handles[i]);
+    }
+
+    copy = pqCopy(pq);
+    second_copy = pqCopy(copy);
+    ASSERT_TEST(copy != NULL && second_copy != NULL, destroy);
+    ASSERT_TEST(pqGetSize(copy) == 5 && pqContains(second_copy, &values[3]), destroy);
+
+    // a copy gives out its own elements, and the original keeps giving out its own
+    int *pq_first = pqGetFirst(pq);
+    int *first = pqGetFirst(copy);
+    ASSERT_TEST(first != pq_first && *first == 9 && *pq_first == 9 && *(int *) pqGetNext(copy) == 7, destroy);
+
+    // a change of the copy does not touch the other queues
+    ASSERT_TEST(pqRemoveElement(copy, &values[0]) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqGetSize(copy) == 4 && pqGetSize(pq) == 5 && pqGetSize(second_copy) == 5, destroy);
+    ASSERT_TEST(*pq_first == 9 && pqContains(pq, &values[0]), destroy);
+
+    // a change of the original keeps its nodes, so its handles stay valid, and the elements the
+    // second copy gave out stay valid until the second copy changes
+    first = pqGetFirst(second_copy);
+    ASSERT_TEST(first != pq_first && *first == 9 && *(int *) pqGetNext(second_copy) == 7, destroy);
+    ASSERT_TEST(pqUpdatePriorityByHandle(pq, handles[2], &values[1]) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqRemoveByHandle(pq, handles[1]) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(*first == 9 && *(int *) pqGetNext(second_copy) == 5 && *(int *) pqGetNext(second_copy) == 3, destroy);
+    ASSERT_TEST(*(int *) pqGetFirst(pq) == 1 && *(int *) pqGetFirst(second_copy) == 9, destroy);
+
+    // clearing or destroying a queue that shares its entries does not touch the others
+    pqDestroy(copy);
+    copy = pqCopy(second_copy);
+    ASSERT_TEST(pqClear(second_copy) == PQ_SUCCESS && pqGetSize(second_copy) == 0, destroy);
+    ASSERT_TEST(pqGetSize(copy) == 5 && *(int *) pqGetFirst(copy) == 9, destroy);
+    pqDestroy(second_copy);
+    second_copy = pqCopy(copy);
+    pqDestroy(copy);
+    copy = NULL;
+    ASSERT_TEST(pqInsert(second_copy, &values[0], &values[1]) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqGetSize(second_copy) == 6 && pqShrinkToFit(second_copy) == PQ_SUCCESS, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    pqDestroy(copy);
+    pqDestroy(second_copy);
+    return result;
+}
+
+bool testPQMergeMovesEntries() {
+    bool result = true;
+    PQ pq = createHashedPQ(PQ_ENGINE_SORTED_LIST);
+    PQ heap_pq = createHeapPQ(2);
+    PQ other_pq = pqCreate(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric, freeIntGeneric,
+                           compareIntsGeneric);
+    PQ pairing_pq = createHashedPQ(PQ_ENGINE_PAIRING);
+    PQ pairing_source = createHashedPQ(PQ_ENGINE_PAIRING);
+    PQHandle handle;
+    int values[] = {5, 2, 8, 2, 7, 1};
+    for (int i = 0; i < 3; i++) {
+        pqInsert(pq, &values[i], &values[i]);
+    }
+    for (int i = 3; i < 6; i++) {
+        pqInsertWithHandle(heap_pq, &values[i], &values[i], &handle);
+    }
+    int *first_elem = pqGetFirst(heap_pq);
+
+    ASSERT_TEST(pqMerge(pq, pq) == PQ_ERROR && pqMerge(NULL, pq) == PQ_NULL_ARGUMENT, destroy);
+    ASSERT_TEST(pqMerge(pq, heap_pq) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqGetSize(pq) == 6 && pqGetSize(heap_pq) == 0 && pqGetFirst(heap_pq) == NULL, destroy);
+    ASSERT_TEST(pqContains(pq, &values[5]), destroy);
+
+    // the element moved without a copy, and the handle now belongs to pq
+    ASSERT_TEST(*(int *) pqGetFirst(pq) == 8 && pqGetNext(pq) == first_elem, destroy);
+    ASSERT_TEST(pqUpdatePriorityByHandle(pq, handle, &values[2]) == PQ_SUCCESS, destroy);
+
+    // 8 (from pq) was inserted before 1 (from heap_pq), and the 2 of pq before the 2 of heap_pq
+    int expected[] = {8, 1, 7, 5, 2, 2};
+    int i = 0;
+    PQ_FOREACH(int *, elem, pq) {
+        ASSERT_TEST(*elem == expected[i], destroy);
+        i++;
+    }
+
+    ASSERT_TEST(pqMerge(heap_pq, pq) == PQ_SUCCESS && pqGetSize(heap_pq) == 6, destroy);
+    ASSERT_TEST(*(int *) pqGetFirst(heap_pq) == 8 && pqInsert(pq, &values[0], &values[0]) == PQ_SUCCESS, destroy);
+    ASSERT_TEST(pqMerge(other_pq, heap_pq) == PQ_SUCCESS && pqGetSize(other_pq) == 6, destroy);
+
+    // the nodes of a melded queue, in use and free, are reused by the destination and by the source
+    for (int round = 0; round < 3; round++) {
+        for (int j = 0; j < 40; j++) {
+            int value = round * 100 + j;
+            ASSERT_TEST(pqInsert(pairing_source, &value, &value) == PQ_SUCCESS, destroy);
+        }
+        for (int j = 0; j < 20; j++) {
+            pqRemove(pairing_source);
+        }
+        ASSERT_TEST(pqMerge(pairing_pq, pairing_source) == PQ_SUCCESS && pqGetSize(pairing_source) == 0, destroy);
+        for (int j = 0; j < 10; j++) {
+            pqRemove(pairing_pq);
+        }
+    }
+    ASSERT_TEST(pqGetSize(pairing_pq) == 30 && pqShrinkToFit(pairing_pq) == PQ_SUCCESS, destroy);
+    for (int j = 0; j < 30; j++) {
+        ASSERT_TEST(pqInsert(pairing_pq, &j, &j) == PQ_SUCCESS, destroy);
+    }
+    int previous = INT_MAX;
+    for (int j = 0; j < 60; j++) {
+        int *priority = NULL;
+        int *elem = pqPop(pairing_pq, (PQElementPriority *) &priority);
+        ASSERT_TEST(elem != NULL && *priority <= previous, destroy);
+        previous = *priority;
+        free(elem);
+        free(priority);
+    }
+    ASSERT_TEST(pqGetSize(pairing_pq) == 0, destroy);
+
+    destroy:
+    pqDestroy(pq);
+    pqDestroy(heap_pq);
+    pqDestroy(other_pq);
+    pqDestroy(pairing_pq);
+    pqDestroy(pairing_source);
+    return result;
+}
+
+#define CONCURRENT_THREADS 4
+#define CONCURRENT_ELEMENTS_PER_THREAD 500
+
+typedef struct {
+    ConcurrentPriorityQueue queue;
+    int first_element;
+    int popped_count;
+    long popped_sum;
+} ConcurrentTestArgs;
+
+static void *insertConcurrentElements(void *arg) {
+    ConcurrentTestArgs *args = arg;
+    for (int i = args->first_element; i < args->first_element + CONCURRENT_ELEMENTS_PER_THREAD; i++) {
+        int priority = i % 97;
+        if (pqConcurrentInsert(args->queue, &i, &priority) != PQ_SUCCESS) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+static void *popConcurrentElements(void *arg) {
+    ConcurrentTestArgs *args = arg;
+    int *elem;
+    while ((elem = pqConcurrentPop(args->queue, NULL)) != NULL) {
+        args->popped_count++;
+        args->popped_sum += *elem;
+        free(elem);
+    }
+    return NULL;
+}
+
+static void *sumConcurrentElements(void *arg) {
+    ConcurrentTestArgs *args = arg;
+    PQConcurrentIterator iterator;
+    for (int *elem = pqConcurrentIterBegin(args->queue, &iterator); elem != NULL;
+         elem = pqConcurrentIterNext(&iterator)) {
+        args->popped_count++;
+        args->popped_sum += *elem;
+    }
+    pqConcurrentIterEnd(&iterator);
+    return NULL;
+}
+
+static bool runConcurrentThreads(ConcurrentTestArgs *args, void *(*routine)(void *)) {
+    pthread_t threads[CONCURRENT_THREADS];
+    int started = 0;
+    while (started < CONCURRENT_THREADS && pthread_create(&threads[started], NULL, routine, &args[started]) == 0) {
+        started++;
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    return started == CONCURRENT_THREADS;
+}
+
+bool testPQConcurrentInsertAndPopFromThreads() {
+    bool result = true;
+    ConcurrentPriorityQueue queue = pqCreateConcurrent(copyIntGeneric, freeIntGeneric, equalIntsGeneric,
+                                                       copyIntGeneric, freeIntGeneric, compareIntsGeneric,
+                                                       NULL, 0, PQ_ORDER_RELAXED);
+    ASSERT_TEST(queue != NULL, destroy);
+
+    ConcurrentTestArgs args[CONCURRENT_THREADS];
+    for (int i = 0; i < CONCURRENT_THREADS; i++) {
+        args[i] = (ConcurrentTestArgs) {queue, i * CONCURRENT_ELEMENTS_PER_THREAD, 0, 0};
+    }
+    ASSERT_TEST(runConcurrentThreads(args, insertConcurrentElements), destroy);
+
+    int total = CONCURRENT_THREADS * CONCURRENT_ELEMENTS_PER_THREAD;
+    ASSERT_TEST(pqConcurrentGetSize(queue) == total, destroy);
+    ASSERT_TEST(runConcurrentThreads(args, popConcurrentElements), destroy);
+
+    // every element is popped exactly once
+    int popped_count = 0;
+    long popped_sum = 0;
+    for (int i = 0; i < CONCURRENT_THREADS; i++) {
+        popped_count += args[i].popped_count;
+        popped_sum += args[i].popped_sum;
+    }
+    ASSERT_TEST(popped_count == total && popped_sum == (long) total * (total - 1) / 2, destroy);
+    ASSERT_TEST(pqConcurrentGetSize(queue) == 0 && pqConcurrentPop(queue, NULL) == NULL, destroy);
+
+    destroy:
+    pqConcurrentDestroy(queue);
+    return result;
+}
+
+bool testPQConcurrentStrictOrder() {
+    bool result = true;
+    PQOptions bounded_options = {.capacity = 10};
+    ASSERT_TEST(pqCreateConcurrent(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric,
+                                   freeIntGeneric, compareIntsGeneric, &bounded_options, 0,
+                                   PQ_ORDER_STRICT) == NULL, end);
+    ASSERT_TEST(pqCreateConcurrent(copyIntGeneric, freeIntGeneric, equalIntsGeneric, copyIntGeneric,
+                                   freeIntGeneric, compareIntsGeneric, NULL, -1, PQ_ORDER_STRICT) == NULL, end);
+
+    PQOptions heap_options = {.engine = PQ_ENGINE_HEAP};
+    ConcurrentPriorityQueue queue = pqCreateConcurrent(copyIntGeneric, freeIntGeneric, equalIntsGeneric,
+                                                       copyIntGeneric, freeIntGeneric, compareIntsGeneric,
+                                                       &heap_options, 3, PQ_ORDER_STRICT);
+    ASSERT_TEST(queue != NULL, end);
+
+    ConcurrentTestArgs args[CONCURRENT_THREADS];
+    for (int i = 0; i < CONCURRENT_THREADS; i++) {
+        args[i] = (ConcurrentTestArgs) {queue, i * CONCURRENT_ELEMENTS_PER_THREAD, 0, 0};
+    }
+    ASSERT_TEST(runConcurrentThreads(args, insertConcurrentElements), destroy);
+
+    // the priorities come out from the highest down
+    int last_priority = 96;
+    int popped_count = 0;
+    int *elem;
+    int *priority;
+    while ((elem = pqConcurrentPop(queue, (PQElementPriority *) &priority)) != NULL) {
+        bool is_in_order = *priority <= last_priority && *priority == *elem % 97;
+        last_priority = *priority;
+        popped_count++;
+        free(elem);
+        free(priority);
+        ASSERT_TEST(is_in_order, destroy);
+    }
+    ASSERT_TEST(popped_count == CONCURRENT_THREADS * CONCURRENT_ELEMENTS_PER_THREAD, destroy);
+
+    destroy:
+    pqConcurrentDestroy(queue);
+    end:
+    return result;
+}
+
+bool testPQConcurrentIteratorsReadTogether() {
+    bool result = true;
+    PQOptions heap_options = {.engine = PQ_ENGINE_HEAP};
+    ConcurrentPriorityQueue queue = pqCreateConcurrent(copyIntGeneric, freeIntGeneric, equalIntsGeneric,
+                                                       copyIntGeneric, freeIntGeneric, compareIntsGeneric,
+                                                       &heap_options, 0, PQ_ORDER_RELAXED);
+    ASSERT_TEST(queue != NULL, destroy);
+
+    int total = CONCURRENT_ELEMENTS_PER_THREAD;
+    for (int i = 0; i < total; i++) {
+        ASSERT_TEST(pqConcurrentInsert(queue, &i, &i) == PQ_SUCCESS, destroy);
+    }
+
+    // the readers iterate at the same time, and every one of them sees all the elements
+    ConcurrentTestArgs args[CONCURRENT_THREADS];
+    for (int i = 0; i < CONCURRENT_THREADS; i++) {
+        args[i] = (ConcurrentTestArgs) {queue, 0, 0, 0};
+    }
+    ASSERT_TEST(runConcurrentThreads(args, sumConcurrentElements), destroy);
+    for (int i = 0; i < CONCURRENT_THREADS; i++) {
+        ASSERT_TEST(args[i].popped_count == total && args[i].popped_sum == (long) total * (total - 1) / 2, destroy);
+    }
+
+    // the queue can be changed again once the iterations ended
+    int *elem = pqConcurrentPop(queue, NULL);
+    ASSERT_TEST(elem != NULL && pqConcurrentGetSize(queue) == total - 1, destroy);
+    free(elem);
+
+    destroy:
+    pqConcurrentDestroy(queue);
+    return result;
+}
+
+
 /* ============= Course given tests ============= */
 bool testPQCreateDestroy() {
     bool result = true;
@@ -821,7 +2366,36 @@ bool (*tests[])(void) = {
         testPQGetNextStandardTest,
         testPQGetNextTraversesTheQueueCorrectlyByPriority,
         testPQClearStandardTest,
-        testPQClearWorksOkayOnEmptyQueue
+        testPQClearWorksOkayOnEmptyQueue,
+        testPQCreateWithOptionsIllegalOptions,
+        testPQHeapKeepsInsertionOrderBetweenEqualPriorities,
+        testPQHeapMatchesSortedList,
+        testPQGetSizeFollowsAllChanges,
+        testPQHashIndexMatchesScan,
+        testPQHandleUpdateAndRemove,
+        testPQNodePoolReuseAndShrink,
+        testPQInsertTakeAndPopTake,
+        testPQPopAndPopN,
+        testPQInsertBatchMatchesInsert,
+        testPQBoundedQueueEvictsLowest,
+        testPQBoundedQueueRejects,
+        testPQConcurrentInsertAndPopFromThreads,
+        testPQConcurrentStrictOrder,
+        testPQIteratorsAreIndependent,
+        testPQConcurrentIteratorsReadTogether,
+        testPQCopySharesUntilChange,
+        testPQMergeMovesEntries,
+        testPQPairingMatchesSortedList,
+        testIPQMatchesPriorityQueue,
+        testPQInlineStorageMatchesCallbacks,
+        testTypedPQMatchesPriorityQueue,
+        testPQChangePriorityBatchMatchesSingleChanges,
+        testPQLazyRemovalMatchesImmediate,
+        testPQStatsCountOperations,
+        testPQGetFirstAndRemoveDrainIsFast,
+        testPQShrinkToFitKeepsIterators,
+        testPQChangePriorityBatchWalksOnce,
+        testPQBoundedHeapMatchesSortedList
 };
 
 const char *testNames[] = {
@@ -862,7 +2436,36 @@ const char *testNames[] = {
         "testPQGetNextStandardTest",
         "testPQGetNextTraversesTheQueueCorrectlyByPriority",
         "testPQClearStandardTest",
-        "testPQClearWorksOkayOnEmptyQueue"
+        "testPQClearWorksOkayOnEmptyQueue",
+        "testPQCreateWithOptionsIllegalOptions",
+        "testPQHeapKeepsInsertionOrderBetweenEqualPriorities",
+        "testPQHeapMatchesSortedList",
+        "testPQGetSizeFollowsAllChanges",
+        "testPQHashIndexMatchesScan",
+        "testPQHandleUpdateAndRemove",
+        "testPQNodePoolReuseAndShrink",
+        "testPQInsertTakeAndPopTake",
+        "testPQPopAndPopN",
+        "testPQInsertBatchMatchesInsert",
+        "testPQBoundedQueueEvictsLowest",
+        "testPQBoundedQueueRejects",
+        "testPQConcurrentInsertAndPopFromThreads",
+        "testPQConcurrentStrictOrder",
+        "testPQIteratorsAreIndependent",
+        "testPQConcurrentIteratorsReadTogether",
+        "testPQCopySharesUntilChange",
+        "testPQMergeMovesEntries",
+        "testPQPairingMatchesSortedList",
+        "testIPQMatchesPriorityQueue",
+        "testPQInlineStorageMatchesCallbacks",
+        "testTypedPQMatchesPriorityQueue",
+        "testPQChangePriorityBatchMatchesSingleChanges",
+        "testPQLazyRemovalMatchesImmediate",
+        "testPQStatsCountOperations",
+        "testPQGetFirstAndRemoveDrainIsFast",
+        "testPQShrinkToFitKeepsIterators",
+        "testPQChangePriorityBatchWalksOnce",
+        "testPQBoundedHeapMatchesSortedList"
 };
 
 const char *testFailDescriptions[] = {
@@ -903,11 +2506,40 @@ const char *testFailDescriptions[] = {
         "Please refer to the testing code at function: testPQGetNextStandardTest",
         "Please refer to the testing code at function: testPQGetNextTraversesTheQueueCorrectlyByPriority",
         "Please refer to the testing code at function: testPQClearStandardTest",
-        "Please refer to the testing code at function: testPQClearWorksOkayOnEmptyQueue"
+        "Please refer to the testing code at function: testPQClearWorksOkayOnEmptyQueue",
+        "Please refer to the testing code at function: testPQCreateWithOptionsIllegalOptions",
+        "Please refer to the testing code at function: testPQHeapKeepsInsertionOrderBetweenEqualPriorities",
+        "Please refer to the testing code at function: testPQHeapMatchesSortedList",
+        "Please refer to the testing code at function: testPQGetSizeFollowsAllChanges",
+        "Please refer to the testing code at function: testPQHashIndexMatchesScan",
+        "Please refer to the testing code at function: testPQHandleUpdateAndRemove",
+        "Please refer to the testing code at function: testPQNodePoolReuseAndShrink",
+        "Please refer to the testing code at function: testPQInsertTakeAndPopTake",
+        "Please refer to the testing code at function: testPQPopAndPopN",
+        "Please refer to the testing code at function: testPQInsertBatchMatchesInsert",
+        "Please refer to the testing code at function: testPQBoundedQueueEvictsLowest",
+        "Please refer to the testing code at function: testPQBoundedQueueRejects",
+        "Please refer to the testing code at function: testPQConcurrentInsertAndPopFromThreads",
+        "Please refer to the testing code at function: testPQConcurrentStrictOrder",
+        "Please refer to the testing code at function: testPQIteratorsAreIndependent",
+        "Please refer to the testing code at function: testPQConcurrentIteratorsReadTogether",
+        "Please refer to the testing code at function: testPQCopySharesUntilChange",
+        "Please refer to the testing code at function: testPQMergeMovesEntries",
+        "Please refer to the testing code at function: testPQPairingMatchesSortedList",
+        "Please refer to the testing code at function: testIPQMatchesPriorityQueue",
+        "Please refer to the testing code at function: testPQInlineStorageMatchesCallbacks",
+        "Please refer to the testing code at function: testTypedPQMatchesPriorityQueue",
+        "Please refer to the testing code at function: testPQChangePriorityBatchMatchesSingleChanges",
+        "Please refer to the testing code at function: testPQLazyRemovalMatchesImmediate",
+        "Please refer to the testing code at function: testPQStatsCountOperations",
+        "Please refer to the testing code at function: testPQGetFirstAndRemoveDrainIsFast",
+        "Please refer to the testing code at function: testPQShrinkToFitKeepsIterators",
+        "Please refer to the testing code at function: testPQChangePriorityBatchWalksOnce",
+        "Please refer to the testing code at function: testPQBoundedHeapMatchesSortedList"
 };
 
 
-#define NUMBER_TESTS 38
+#define NUMBER_TESTS 67
 
 int main(int argc, char **argv) {
     if (argc == 1) {